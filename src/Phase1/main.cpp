@@ -4,6 +4,46 @@
 #include <string>
 #include <random>
 #include <ctime>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <cstdint>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Contoare hardware pentru --bench --perf (perf_event_open exista doar pe Linux)
+#if defined(__linux__)
+#define PERF_COUNTERS 1
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#define PERF_COUNTERS 0
+#endif
+
+// --- FARA FMA ---
+// Contopirea mul + add intr-un FMA depinde de compilator si de flag-uri (-march=native o
+// face si in codul scalar), deci kernel-ele pe ISA-uri diferite ar rotunji diferit.
+// O oprim pentru tot fisierul: fiecare varianta SIMD da acelasi rezultat ca cea scalara.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
 
 const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
@@ -12,32 +52,174 @@ const int NUM_PARTICULE = 200000;
 
 const float RAZA_PARTICULA = 3.0f; // Marimea "sprite-ului"
 
+// --- GRID PENTRU BROADPHASE (DOD) ---
+// Celula e putin mai mare decat distanta de coliziune (2 * raza): orice pereche care
+// se poate ciocni e in aceeasi celula sau intr-una vecina, chiar cu erori de rotunjire.
+const float GRID_CELL_SIZE = RAZA_PARTICULA * 2 + 0.5f;
+const int GRID_COLS = (int)(WINDOW_WIDTH / GRID_CELL_SIZE) + 1;
+const int GRID_ROWS = (int)(WINDOW_HEIGHT / GRID_CELL_SIZE) + 1;
+
 float randomFloat(float min, float max) {
     return min + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (max - min)));
 }
 
+// ==========================================
+// SIMD: memorie aliniata + detectie ISA la runtime
+// ==========================================
+inline void* alignedAlloc(size_t bytes, size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0) return nullptr;
+    return p;
+#endif
+}
+
+inline void alignedFree(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// Allocator pentru std::vector: inceputul fiecarui array e pe linie de cache (64),
+// deci load-urile SIMD aliniate si impartirea pe thread-uri pornesc de la o granita curata.
+template <typename T, size_t ALIGN = 64>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef AlignedAllocator<U, ALIGN> other; };
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, ALIGN>&) {}
+
+    T* allocate(size_t n) {
+        void* p = alignedAlloc(n * sizeof(T), ALIGN);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) { alignedFree(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, ALIGN>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, ALIGN>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 };
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_SSE2: return "SSE2";
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+SimdLevel parseSimdLevel(const char* name) {
+    if (strcmp(name, "avx512") == 0) return SIMD_AVX512;
+    if (strcmp(name, "avx2") == 0) return SIMD_AVX2;
+    if (strcmp(name, "sse2") == 0) return SIMD_SSE2;
+    return SIMD_SCALAR;
+}
+
+#if defined(SIMD_X86)
+// FMA e oprit pentru tot fisierul (sus), deci si aici
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+inline void cpuidQuery(int out[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    out[0] = (int)a; out[1] = (int)b; out[2] = (int)c; out[3] = (int)d;
+#endif
+}
+
+inline unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+// CPUID + XGETBV (OS-ul trebuie sa salveze si registrii YMM/ZMM)
+SimdLevel detectSimdLevel() {
+#if defined(SIMD_X86)
+    int info[4];
+    cpuidQuery(info, 0, 0);
+    int maxLeaf = info[0];
+
+    cpuidQuery(info, 1, 0);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!sse2) return SIMD_SCALAR;
+    if (!osxsave || !avx || maxLeaf < 7) return SIMD_SSE2;
+
+    unsigned long long xcr0 = xgetbv0();
+    bool osYmm = (xcr0 & 0x6) == 0x6;
+    bool osZmm = (xcr0 & 0xE6) == 0xE6;
+
+    cpuidQuery(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool avx512f = (info[1] & (1 << 16)) != 0;
+
+    if (avx512f && osZmm) return SIMD_AVX512;
+    if (avx2 && osYmm) return SIMD_AVX2;
+    return SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
 // ==========================================
 // ABORDAREA 1: OOP (Object Oriented)
 // ==========================================
-class ParticleOOP {
+
+// --- JUNK DATA MASIV ---
+// Implicit 4000 bytes (~4KB) per obiect.
+// 30.000 obiecte * 4KB = 120 MB RAM.
+// Asta e mult peste cei 16MB Cache ai i9-lui.
+// Procesorul VA FI OBLIGAT sa astepte dupa RAM.
+// Marimea e parametru de template ca benchmark-ul sa poata baleia 0 -> 4KB.
+template <int N>
+struct Padding {
+    char padding[N];
+    void touch() { padding[0] = 'X'; } // Scriem ceva sa nu fie optimizat
+};
+
+template <>
+struct Padding<0> {
+    void touch() {}
+};
+
+template <int PADDING = 4000>
+class ParticleOOP : public Padding<PADDING> {
 public:
     float x, y;
     float vx, vy;
 
-    // --- JUNK DATA MASIV ---
-    // Marim la 4096 bytes (4KB) per obiect.
-    // 30.000 obiecte * 4KB = 120 MB RAM.
-    // Asta e mult peste cei 16MB Cache ai i9-lui.
-    // Procesorul VA FI OBLIGAT sa astepte dupa RAM.
-    char padding[4000];
-    // -----------------------
-
     ParticleOOP() {
         x = randomFloat(0, (float)WINDOW_WIDTH);
         y = randomFloat(0, (float)WINDOW_HEIGHT);
         vx = randomFloat(-200.0f, 200.0f);
         vy = randomFloat(-200.0f, 200.0f);
-        padding[0] = 'X'; // Scriem ceva sa nu fie optimizat
+        this->touch();
     }
 
     void update(float deltaTime) {
@@ -68,17 +250,140 @@ public:
     }
 };
 
+// ==========================================
+// KERNELE SIMD PENTRU UPDATE (DOD)
+// ==========================================
+// Aceeasi integrare ca in bucla scalara, dar bounce-ul e o inversare de semn
+// mascata (fara branch). Toate variantele fac aceleasi operatii float in aceeasi
+// ordine, deci rezultatele sunt identice bit cu bit.
+typedef void (*UpdateKernel)(float* x, float* y, float* vx, float* vy, int count, float deltaTime);
+
+void updateScalar(float* x, float* y, float* vx, float* vy, int count, float deltaTime) {
+    // Procesare liniara - Procesorul "zboara" prin acesti vectori
+    for (int i = 0; i < count; i++) {
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+
+        if (x[i] <= 0 || x[i] >= WINDOW_WIDTH - RAZA_PARTICULA) vx[i] *= -1;
+        if (y[i] <= 0 || y[i] >= WINDOW_HEIGHT - RAZA_PARTICULA) vy[i] *= -1;
+    }
+}
+
+#if defined(SIMD_X86)
+void updateSSE2(float* x, float* y, float* vx, float* vy, int count, float deltaTime) {
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 maxX = _mm_set1_ps(WINDOW_WIDTH - RAZA_PARTICULA);
+    const __m128 maxY = _mm_set1_ps(WINDOW_HEIGHT - RAZA_PARTICULA);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vxi = _mm_load_ps(vx + i);
+        __m128 vyi = _mm_load_ps(vy + i);
+        __m128 xi = _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(vxi, dt));
+        __m128 yi = _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(vyi, dt));
+
+        __m128 hitX = _mm_or_ps(_mm_cmple_ps(xi, zero), _mm_cmpge_ps(xi, maxX));
+        __m128 hitY = _mm_or_ps(_mm_cmple_ps(yi, zero), _mm_cmpge_ps(yi, maxY));
+
+        _mm_store_ps(x + i, xi);
+        _mm_store_ps(y + i, yi);
+        _mm_store_ps(vx + i, _mm_xor_ps(vxi, _mm_and_ps(hitX, sign)));
+        _mm_store_ps(vy + i, _mm_xor_ps(vyi, _mm_and_ps(hitY, sign)));
+    }
+    updateScalar(x + i, y + i, vx + i, vy + i, count - i, deltaTime);
+}
+
+TARGET_AVX2 void updateAVX2(float* x, float* y, float* vx, float* vy, int count, float deltaTime) {
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 maxX = _mm256_set1_ps(WINDOW_WIDTH - RAZA_PARTICULA);
+    const __m256 maxY = _mm256_set1_ps(WINDOW_HEIGHT - RAZA_PARTICULA);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vxi = _mm256_load_ps(vx + i);
+        __m256 vyi = _mm256_load_ps(vy + i);
+        __m256 xi = _mm256_add_ps(_mm256_load_ps(x + i), _mm256_mul_ps(vxi, dt));
+        __m256 yi = _mm256_add_ps(_mm256_load_ps(y + i), _mm256_mul_ps(vyi, dt));
+
+        __m256 hitX = _mm256_or_ps(_mm256_cmp_ps(xi, zero, _CMP_LE_OQ), _mm256_cmp_ps(xi, maxX, _CMP_GE_OQ));
+        __m256 hitY = _mm256_or_ps(_mm256_cmp_ps(yi, zero, _CMP_LE_OQ), _mm256_cmp_ps(yi, maxY, _CMP_GE_OQ));
+
+        _mm256_store_ps(x + i, xi);
+        _mm256_store_ps(y + i, yi);
+        _mm256_store_ps(vx + i, _mm256_blendv_ps(vxi, _mm256_xor_ps(vxi, sign), hitX));
+        _mm256_store_ps(vy + i, _mm256_blendv_ps(vyi, _mm256_xor_ps(vyi, sign), hitY));
+    }
+    updateScalar(x + i, y + i, vx + i, vy + i, count - i, deltaTime);
+}
+
+TARGET_AVX512 void updateAVX512(float* x, float* y, float* vx, float* vy, int count, float deltaTime) {
+    const __m512 dt = _mm512_set1_ps(deltaTime);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i sign = _mm512_set1_epi32((int)0x80000000U);
+    const __m512 maxX = _mm512_set1_ps(WINDOW_WIDTH - RAZA_PARTICULA);
+    const __m512 maxY = _mm512_set1_ps(WINDOW_HEIGHT - RAZA_PARTICULA);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 vxi = _mm512_load_ps(vx + i);
+        __m512 vyi = _mm512_load_ps(vy + i);
+        __m512 xi = _mm512_add_ps(_mm512_load_ps(x + i), _mm512_mul_ps(vxi, dt));
+        __m512 yi = _mm512_add_ps(_mm512_load_ps(y + i), _mm512_mul_ps(vyi, dt));
+
+        __mmask16 hitX = _mm512_cmp_ps_mask(xi, zero, _CMP_LE_OQ) | _mm512_cmp_ps_mask(xi, maxX, _CMP_GE_OQ);
+        __mmask16 hitY = _mm512_cmp_ps_mask(yi, zero, _CMP_LE_OQ) | _mm512_cmp_ps_mask(yi, maxY, _CMP_GE_OQ);
+        __m512i vxBits = _mm512_castps_si512(vxi);
+        __m512i vyBits = _mm512_castps_si512(vyi);
+
+        _mm512_store_ps(x + i, xi);
+        _mm512_store_ps(y + i, yi);
+        _mm512_store_ps(vx + i, _mm512_castsi512_ps(_mm512_mask_xor_epi32(vxBits, hitX, vxBits, sign)));
+        _mm512_store_ps(vy + i, _mm512_castsi512_ps(_mm512_mask_xor_epi32(vyBits, hitY, vyBits, sign)));
+    }
+    updateScalar(x + i, y + i, vx + i, vy + i, count - i, deltaTime);
+}
+#endif
+
+UpdateKernel selectUpdateKernel(SimdLevel level) {
+#if defined(SIMD_X86)
+    switch (level) {
+    case SIMD_AVX512: return updateAVX512;
+    case SIMD_AVX2: return updateAVX2;
+    case SIMD_SSE2: return updateSSE2;
+    default: break;
+    }
+#endif
+    return updateScalar;
+}
+
 // ==========================================
 // ABORDAREA 2: DOD (Data Oriented)
 // ==========================================
+enum BroadphaseMode { BROADPHASE_BRUTE, BROADPHASE_GRID };
+
 struct ParticleSystemDOD {
     // Vectori separati (Structure of Arrays)
     // Aici NU avem junk data printre float-uri. Procesorul citeste doar X, apoi doar Y.
-    std::vector<float> x;
-    std::vector<float> y;
-    std::vector<float> vx;
-    std::vector<float> vy;
+    // Aliniati la 64 bytes: kernel-urile SIMD folosesc load-uri aliniate.
+    AlignedVector<float> x;
+    AlignedVector<float> y;
+    AlignedVector<float> vx;
+    AlignedVector<float> vy;
     int count = 0;
+    UpdateKernel kernel = updateScalar; // Ales la pornire dupa CPUID
+    BroadphaseMode broadphase = BROADPHASE_BRUTE; // 'G' comuta pe grid
+
+    // Grid uniform construit cu counting sort (refolosit de la un frame la altul)
+    std::vector<int> cellStart;   // GRID_COLS * GRID_ROWS + 1 offset-uri
+    std::vector<int> cellOf;      // Celula fiecarei particule
+    std::vector<int> sortedIndex; // Particulele ordonate pe celule
+    AlignedVector<float> sortedX;
+    AlignedVector<float> sortedY;
+    std::vector<unsigned char> hitFlags; // Pe sloturi sortate
 
     void init(int num) {
         count = num;
@@ -96,18 +401,17 @@ struct ParticleSystemDOD {
     }
 
     void update(float deltaTime) {
-        // Procesare liniara - Procesorul "zboara" prin acesti vectori
-        for (int i = 0; i < count; i++) {
-            x[i] += vx[i] * deltaTime;
-            y[i] += vy[i] * deltaTime;
+        kernel(x.data(), y.data(), vx.data(), vy.data(), count, deltaTime);
+    }
 
-            if (x[i] <= 0 || x[i] >= WINDOW_WIDTH - RAZA_PARTICULA) vx[i] *= -1;
-            if (y[i] <= 0 || y[i] >= WINDOW_HEIGHT - RAZA_PARTICULA) vy[i] *= -1;
-        }
+    void checkCollisions() {
+        if (broadphase == BROADPHASE_GRID) checkCollisionsGrid();
+        else checkCollisionsBrute();
     }
 
     // Coliziune DOD - Implementata pentru corectitudinea comparatiei
-    void checkCollisions() {
+    // O(n^2), ramane ca referinta pentru varianta cu grid
+    void checkCollisionsBrute() {
         for (int i = 0; i < count; i++) {
             for (int j = 0; j < count; j++) {
                 if (i == j) continue;
@@ -125,12 +429,1105 @@ struct ParticleSystemDOD {
             }
         }
     }
+
+    // Primul slot din [first, last) aflat la distanta de coliziune de slotul s, sau -1
+    int findNeighbor(int s, int first, int last, float minDistSq) const {
+        float px = sortedX[s];
+        float py = sortedY[s];
+        for (int t = first; t < last; t++) {
+            float dx = sortedX[t] - px;
+            float dy = sortedY[t] - py;
+            if (dx * dx + dy * dy < minDistSq && t != s) return t;
+        }
+        return -1;
+    }
+
+    int cellIndex(float px, float py) const {
+        int cx = std::min(std::max((int)(px / GRID_CELL_SIZE), 0), GRID_COLS - 1);
+        int cy = std::min(std::max((int)(py / GRID_CELL_SIZE), 0), GRID_ROWS - 1);
+        return cy * GRID_COLS + cx;
+    }
+
+    // Acelasi rezultat ca checkCollisionsBrute: o particula isi inverseaza viteza daca
+    // exista ORICE alta particula la distanta < 2 * raza (testul nu depinde de ordine),
+    // dar cautam doar in cele 3x3 celule din jur, parcurse in ordinea din memorie.
+    void checkCollisionsGrid() {
+        const int numCells = GRID_COLS * GRID_ROWS;
+        cellStart.assign(numCells + 1, 0);
+        cellOf.resize(count);
+        sortedIndex.resize(count);
+        sortedX.resize(count);
+        sortedY.resize(count);
+
+        // 1. Histograma pe celule
+        for (int i = 0; i < count; i++) {
+            int c = cellIndex(x[i], y[i]);
+            cellOf[i] = c;
+            cellStart[c + 1]++;
+        }
+
+        // 2. Prefix sum -> inceputul fiecarei celule
+        for (int c = 0; c < numCells; c++) cellStart[c + 1] += cellStart[c];
+
+        // 3. Scatter: copii contigue ale pozitiilor, ordonate pe celule
+        std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) {
+            int slot = cursor[cellOf[i]]++;
+            sortedIndex[slot] = i;
+            sortedX[slot] = x[i];
+            sortedY[slot] = y[i];
+        }
+
+        // 4. Test doar cu vecinii din 3x3 celule. Relatia e simetrica: cand gasim perechea
+        // (s, t) le marcam pe amandoua, iar o particula deja marcata nu mai cauta.
+        const float minDistSq = (RAZA_PARTICULA * 2) * (RAZA_PARTICULA * 2);
+        hitFlags.assign(count, 0);
+
+        for (int cy = 0; cy < GRID_ROWS; cy++) {
+            for (int cx = 0; cx < GRID_COLS; cx++) {
+                int c = cy * GRID_COLS + cx;
+                for (int s = cellStart[c]; s < cellStart[c + 1]; s++) {
+                    if (hitFlags[s]) continue;
+
+                    // Intai celula proprie (vecinii cei mai apropiati), apoi cele 3 randuri
+                    int hitSlot = findNeighbor(s, cellStart[c], cellStart[c + 1], minDistSq);
+                    for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, GRID_ROWS - 1) && hitSlot < 0; ny++) {
+                        int rowStart = ny * GRID_COLS;
+                        // Cele 3 celule de pe un rand sunt contigue in sortedX/sortedY
+                        int first = cellStart[rowStart + std::max(cx - 1, 0)];
+                        int last = cellStart[rowStart + std::min(cx + 1, GRID_COLS - 1) + 1];
+
+                        if (ny == cy) {
+                            hitSlot = findNeighbor(s, first, cellStart[c], minDistSq);
+                            if (hitSlot < 0) hitSlot = findNeighbor(s, cellStart[c + 1], last, minDistSq);
+                        }
+                        else {
+                            hitSlot = findNeighbor(s, first, last, minDistSq);
+                        }
+                    }
+
+                    if (hitSlot >= 0) {
+                        hitFlags[s] = 1;
+                        hitFlags[hitSlot] = 1;
+                    }
+                }
+            }
+        }
+
+        for (int s = 0; s < count; s++) {
+            if (!hitFlags[s]) continue;
+            int i = sortedIndex[s];
+            vx[i] *= -1;
+            vy[i] *= -1;
+        }
+    }
 };
 
+// ==========================================
+// ABORDAREA 3: AoSoA (blocuri de LANES particule)
+// ==========================================
+// Fiecare bloc tine LANES valori x, apoi LANES y, etc. O linie de cache
+// contine doar date "calde", dar vecinii raman in acelasi bloc.
+template <int LANES>
+struct ParticleSystemAoSoA {
+    struct Block {
+        float x[LANES];
+        float y[LANES];
+        float vx[LANES];
+        float vy[LANES];
+    };
+
+    std::vector<Block> blocks;
+    int count = 0;
+
+    void init(int num) {
+        count = num;
+        blocks.assign((num + LANES - 1) / LANES, Block());
+
+        for (int i = 0; i < num; i++) {
+            Block& b = blocks[i / LANES];
+            b.x[i % LANES] = randomFloat(0, (float)WINDOW_WIDTH);
+            b.y[i % LANES] = randomFloat(0, (float)WINDOW_HEIGHT);
+            b.vx[i % LANES] = randomFloat(-200.0f, 200.0f);
+            b.vy[i % LANES] = randomFloat(-200.0f, 200.0f);
+        }
+    }
+
+    void update(float deltaTime) {
+        for (size_t bi = 0; bi < blocks.size(); bi++) {
+            Block& b = blocks[bi];
+            // Ultimul bloc poate fi incomplet: benzile goale au viteza 0, deci raman pe loc
+            for (int l = 0; l < LANES; l++) {
+                b.x[l] += b.vx[l] * deltaTime;
+                b.y[l] += b.vy[l] * deltaTime;
+
+                if (b.x[l] <= 0 || b.x[l] >= WINDOW_WIDTH - RAZA_PARTICULA) b.vx[l] *= -1;
+                if (b.y[l] <= 0 || b.y[l] >= WINDOW_HEIGHT - RAZA_PARTICULA) b.vy[l] *= -1;
+            }
+        }
+    }
+
+    void checkCollisions() {
+        for (int i = 0; i < count; i++) {
+            Block& bi = blocks[i / LANES];
+            int li = i % LANES;
+
+            for (int j = 0; j < count; j++) {
+                if (i == j) continue;
+
+                const Block& bj = blocks[j / LANES];
+                float dx = bj.x[j % LANES] - bi.x[li];
+                float dy = bj.y[j % LANES] - bi.y[li];
+                float distSq = dx * dx + dy * dy;
+
+                if (distSq < (RAZA_PARTICULA * 2) * (RAZA_PARTICULA * 2)) {
+                    bi.vx[li] *= -1;
+                    bi.vy[li] *= -1;
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// ==========================================
+// ABORDAREA 4: HOT / COLD SPLIT
+// ==========================================
+// AoS compact doar cu campurile folosite in update (16 bytes), iar datele
+// "reci" (padding-ul din OOP) stau intr-un vector separat, neatins in bucla.
+struct ParticleHot {
+    float x, y;
+    float vx, vy;
+};
+
+struct ParticleSystemHotCold {
+    std::vector<ParticleHot> hot;
+    int count = 0;
+
+    void init(int num) {
+        count = num;
+        hot.resize(num);
+
+        for (int i = 0; i < num; i++) {
+            hot[i].x = randomFloat(0, (float)WINDOW_WIDTH);
+            hot[i].y = randomFloat(0, (float)WINDOW_HEIGHT);
+            hot[i].vx = randomFloat(-200.0f, 200.0f);
+            hot[i].vy = randomFloat(-200.0f, 200.0f);
+        }
+    }
+
+    void update(float deltaTime) {
+        for (int i = 0; i < count; i++) {
+            ParticleHot& p = hot[i];
+            p.x += p.vx * deltaTime;
+            p.y += p.vy * deltaTime;
+
+            if (p.x <= 0 || p.x >= WINDOW_WIDTH - RAZA_PARTICULA) p.vx *= -1;
+            if (p.y <= 0 || p.y >= WINDOW_HEIGHT - RAZA_PARTICULA) p.vy *= -1;
+        }
+    }
+
+    void checkCollisions() {
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) {
+                if (i == j) continue;
+
+                float dx = hot[j].x - hot[i].x;
+                float dy = hot[j].y - hot[i].y;
+                float distSq = dx * dx + dy * dy;
+
+                if (distSq < (RAZA_PARTICULA * 2) * (RAZA_PARTICULA * 2)) {
+                    hot[i].vx *= -1;
+                    hot[i].vy *= -1;
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// ==========================================
+// ABORDAREA 5: QUANTIZAT (int16 fixed point)
+// ==========================================
+// SoA ca DOD, dar pozitiile si vitezele sunt int16 in unitati de 1/16 px (si 1/16 px/s):
+// 8 bytes per particula in loc de 16, deci jumatate din traficul de memorie per frame.
+// Fereastra incape: 1280 * 16 = 20480 < 32767, viteza maxima 200 * 16 = 3200.
+//
+// Integrare: deplasarea = round(v * dt) se face cu o inmultire Q15 (ca _mm_mulhrs_epi16):
+//   dtQ = round(dt * 32768), d = (v * dtQ + 0x4000) >> 15
+// Toate kernel-urile dau exact acelasi rezultat (aritmetica intreaga).
+//
+// Precizie fata de varianta float, intr-un pas pornit din aceeasi stare:
+//   - rotunjirea deplasarii:          <= 1/32 px
+//   - dt cuantizat (1/32768 s):       <= 200 px/s * 1/65536 s ~= 0.0031 px
+//   - viteza cuantizata (1/32 px/s):  <= 0.016 s / 32 = 0.0005 px
+//   => Q16_STEP_ERROR ~= 0.035 px per pas. Eroarea se repeta la fiecare pas (viteza e
+//   constanta intre bounce-uri), deci o traiectorie poate deriva pana la ~2 px/s la 60 Hz
+//   fata de float. Pentru un sistem de particule e invizibil; --verify il masoara.
+//
+// Coliziunea si render-ul decuantizeaza din mers; scala e putere a lui 2, deci
+// testul de distanta se face direct pe int-uri, exact ca pe valorile decuantizate.
+const int Q16_SCALE = 16;
+const float Q16_INV_SCALE = 1.0f / Q16_SCALE;
+const int Q16_MAX_X = (int)((WINDOW_WIDTH - RAZA_PARTICULA) * Q16_SCALE);
+const int Q16_MAX_Y = (int)((WINDOW_HEIGHT - RAZA_PARTICULA) * Q16_SCALE);
+const int Q16_MIN_DIST = (int)(RAZA_PARTICULA * 2 * Q16_SCALE);
+const float Q16_STEP_ERROR = 0.5f / Q16_SCALE + 200.0f / 65536.0f + 0.016f * 0.5f / Q16_SCALE;
+
+// Grid-ul q16 lucreaza direct pe int-uri: celule de 128 unitati (8 px, >= Q16_MIN_DIST = 96,
+// deci ajung tot 3x3 celule), indexul e o simpla deplasare la dreapta
+const int Q16_CELL_SHIFT = 7;
+const int Q16_GRID_COLS = ((WINDOW_WIDTH * Q16_SCALE) >> Q16_CELL_SHIFT) + 1;
+const int Q16_GRID_ROWS = ((WINDOW_HEIGHT * Q16_SCALE) >> Q16_CELL_SHIFT) + 1;
+
+inline int16_t quantize16(float v) {
+    return (int16_t)std::min(std::max((int)lrintf(v * Q16_SCALE), -32767), 32767);
+}
+
+inline float dequantize16(int16_t q) {
+    return q * Q16_INV_SCALE;
+}
+
+// dt in Q15; limitat la ~1 s ca sa incapa in int16
+inline int16_t quantizeDeltaTime(float deltaTime) {
+    return (int16_t)std::min(std::max((int)lrintf(deltaTime * 32768.0f), 0), 32767);
+}
+
+typedef void (*Q16Kernel)(int16_t* x, int16_t* y, int16_t* vx, int16_t* vy, int count, int16_t dtQ);
+
+void updateQ16Scalar(int16_t* x, int16_t* y, int16_t* vx, int16_t* vy, int count, int16_t dtQ) {
+    for (int i = 0; i < count; i++) {
+        x[i] = (int16_t)(x[i] + ((vx[i] * dtQ + 0x4000) >> 15));
+        y[i] = (int16_t)(y[i] + ((vy[i] * dtQ + 0x4000) >> 15));
+
+        if (x[i] <= 0 || x[i] >= Q16_MAX_X) vx[i] = (int16_t)-vx[i];
+        if (y[i] <= 0 || y[i] >= Q16_MAX_Y) vy[i] = (int16_t)-vy[i];
+    }
+}
+
+#if defined(SIMD_X86)
+// SSE2 nu are _mm_mulhrs_epi16 (SSSE3): produsul pe 32 de biti e hi:lo, iar
+// (hi:lo + 0x4000) >> 15 = 2 * hi + (((lo >> 14) + 1) >> 1)
+inline __m128i mulhrsSSE2(__m128i a, __m128i b) {
+    __m128i hi = _mm_mulhi_epi16(a, b);
+    __m128i lo = _mm_mullo_epi16(a, b);
+    __m128i round = _mm_srli_epi16(_mm_add_epi16(_mm_srli_epi16(lo, 14), _mm_set1_epi16(1)), 1);
+    return _mm_add_epi16(_mm_slli_epi16(hi, 1), round);
+}
+
+void updateQ16SSE2(int16_t* x, int16_t* y, int16_t* vx, int16_t* vy, int count, int16_t dtQ) {
+    const __m128i dt = _mm_set1_epi16(dtQ);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i maxX = _mm_set1_epi16((short)(Q16_MAX_X - 1));
+    const __m128i maxY = _mm_set1_epi16((short)(Q16_MAX_Y - 1));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i vxi = _mm_load_si128((const __m128i*)(vx + i));
+        __m128i vyi = _mm_load_si128((const __m128i*)(vy + i));
+        __m128i xi = _mm_add_epi16(_mm_load_si128((const __m128i*)(x + i)), mulhrsSSE2(vxi, dt));
+        __m128i yi = _mm_add_epi16(_mm_load_si128((const __m128i*)(y + i)), mulhrsSSE2(vyi, dt));
+
+        // x <= 0  <=>  1 > x;  x >= max  <=>  x > max - 1
+        __m128i hitX = _mm_or_si128(_mm_cmpgt_epi16(one, xi), _mm_cmpgt_epi16(xi, maxX));
+        __m128i hitY = _mm_or_si128(_mm_cmpgt_epi16(one, yi), _mm_cmpgt_epi16(yi, maxY));
+
+        _mm_store_si128((__m128i*)(x + i), xi);
+        _mm_store_si128((__m128i*)(y + i), yi);
+        // Negare mascata in complement fata de 2: (v ^ m) - m
+        _mm_store_si128((__m128i*)(vx + i), _mm_sub_epi16(_mm_xor_si128(vxi, hitX), hitX));
+        _mm_store_si128((__m128i*)(vy + i), _mm_sub_epi16(_mm_xor_si128(vyi, hitY), hitY));
+    }
+    updateQ16Scalar(x + i, y + i, vx + i, vy + i, count - i, dtQ);
+}
+
+TARGET_AVX2 void updateQ16AVX2(int16_t* x, int16_t* y, int16_t* vx, int16_t* vy, int count, int16_t dtQ) {
+    const __m256i dt = _mm256_set1_epi16(dtQ);
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i maxX = _mm256_set1_epi16((short)(Q16_MAX_X - 1));
+    const __m256i maxY = _mm256_set1_epi16((short)(Q16_MAX_Y - 1));
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i vxi = _mm256_load_si256((const __m256i*)(vx + i));
+        __m256i vyi = _mm256_load_si256((const __m256i*)(vy + i));
+        __m256i xi = _mm256_add_epi16(_mm256_load_si256((const __m256i*)(x + i)), _mm256_mulhrs_epi16(vxi, dt));
+        __m256i yi = _mm256_add_epi16(_mm256_load_si256((const __m256i*)(y + i)), _mm256_mulhrs_epi16(vyi, dt));
+
+        __m256i hitX = _mm256_or_si256(_mm256_cmpgt_epi16(one, xi), _mm256_cmpgt_epi16(xi, maxX));
+        __m256i hitY = _mm256_or_si256(_mm256_cmpgt_epi16(one, yi), _mm256_cmpgt_epi16(yi, maxY));
+
+        _mm256_store_si256((__m256i*)(x + i), xi);
+        _mm256_store_si256((__m256i*)(y + i), yi);
+        _mm256_store_si256((__m256i*)(vx + i), _mm256_sub_epi16(_mm256_xor_si256(vxi, hitX), hitX));
+        _mm256_store_si256((__m256i*)(vy + i), _mm256_sub_epi16(_mm256_xor_si256(vyi, hitY), hitY));
+    }
+    updateQ16Scalar(x + i, y + i, vx + i, vy + i, count - i, dtQ);
+}
+#endif
+
+// AVX-512F nu are operatii pe 16 biti (ar cere AVX-512BW), deci nivelul AVX-512
+// foloseste kernel-ul AVX2 (16 particule per registru)
+Q16Kernel selectQ16Kernel(SimdLevel level) {
+#if defined(SIMD_X86)
+    switch (level) {
+    case SIMD_AVX512:
+    case SIMD_AVX2: return updateQ16AVX2;
+    case SIMD_SSE2: return updateQ16SSE2;
+    default: break;
+    }
+#endif
+    return updateQ16Scalar;
+}
+
+struct ParticleSystemQ16 {
+    AlignedVector<int16_t> x;
+    AlignedVector<int16_t> y;
+    AlignedVector<int16_t> vx;
+    AlignedVector<int16_t> vy;
+    int count = 0;
+    Q16Kernel kernel = updateQ16Scalar;
+    BroadphaseMode broadphase = BROADPHASE_BRUTE; // 'G' comuta (impreuna cu DOD)
+
+    // Grid uniform ca la DOD, cu copii int16 ordonate pe celule
+    std::vector<int> cellStart;   // Q16_GRID_COLS * Q16_GRID_ROWS + 1 offset-uri
+    std::vector<int> cellOf;
+    std::vector<int> sortedIndex;
+    AlignedVector<int16_t> sortedX;
+    AlignedVector<int16_t> sortedY;
+    std::vector<unsigned char> hitFlags;
+
+    // Aceeasi secventa rand() ca ParticleSystemDOD: cu acelasi seed pornesc din aceeasi stare
+    void init(int num) {
+        resize(num);
+        for (int i = 0; i < num; i++) {
+            x[i] = quantize16(randomFloat(0, (float)WINDOW_WIDTH));
+            y[i] = quantize16(randomFloat(0, (float)WINDOW_HEIGHT));
+            vx[i] = quantize16(randomFloat(-200.0f, 200.0f));
+            vy[i] = quantize16(randomFloat(-200.0f, 200.0f));
+        }
+    }
+
+    void resize(int num) {
+        count = num;
+        x.resize(num);
+        y.resize(num);
+        vx.resize(num);
+        vy.resize(num);
+    }
+
+    // Conversii din / in varianta float (comutarea 'Q' si --verify)
+    void quantizeFrom(const ParticleSystemDOD& src) {
+        resize(src.count);
+        for (int i = 0; i < count; i++) {
+            x[i] = quantize16(src.x[i]);
+            y[i] = quantize16(src.y[i]);
+            vx[i] = quantize16(src.vx[i]);
+            vy[i] = quantize16(src.vy[i]);
+        }
+    }
+
+    void dequantizeTo(ParticleSystemDOD& dst) const {
+        for (int i = 0; i < count && i < dst.count; i++) {
+            dst.x[i] = dequantize16(x[i]);
+            dst.y[i] = dequantize16(y[i]);
+            dst.vx[i] = dequantize16(vx[i]);
+            dst.vy[i] = dequantize16(vy[i]);
+        }
+    }
+
+    void update(float deltaTime) {
+        kernel(x.data(), y.data(), vx.data(), vy.data(), count, quantizeDeltaTime(deltaTime));
+    }
+
+    void checkCollisions() {
+        if (broadphase == BROADPHASE_GRID) checkCollisionsGrid();
+        else checkCollisionsBrute();
+    }
+
+    // O(n^2) ca la DOD; dx, dy, distSq incap in int (20480^2 * 2 < 2^31)
+    void checkCollisionsBrute() {
+        const int minDistSq = Q16_MIN_DIST * Q16_MIN_DIST;
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) {
+                if (i == j) continue;
+
+                int dx = x[j] - x[i];
+                int dy = y[j] - y[i];
+
+                if (dx * dx + dy * dy < minDistSq) {
+                    vx[i] = (int16_t)-vx[i];
+                    vy[i] = (int16_t)-vy[i];
+                    break;
+                }
+            }
+        }
+    }
+
+    int findNeighbor(int s, int first, int last, int minDistSq) const {
+        int px = sortedX[s];
+        int py = sortedY[s];
+        for (int t = first; t < last; t++) {
+            int dx = sortedX[t] - px;
+            int dy = sortedY[t] - py;
+            if (dx * dx + dy * dy < minDistSq && t != s) return t;
+        }
+        return -1;
+    }
+
+    // Fara impartire si fara conversie la float: pozitia e deja in unitati de 1/16 px
+    int cellIndex(int px, int py) const {
+        int cx = std::min(std::max(px >> Q16_CELL_SHIFT, 0), Q16_GRID_COLS - 1);
+        int cy = std::min(std::max(py >> Q16_CELL_SHIFT, 0), Q16_GRID_ROWS - 1);
+        return cy * Q16_GRID_COLS + cx;
+    }
+
+    // Acelasi algoritm ca ParticleSystemDOD::checkCollisionsGrid, deci acelasi rezultat
+    // ca checkCollisionsBrute (testul pe int-uri e exact)
+    void checkCollisionsGrid() {
+        const int numCells = Q16_GRID_COLS * Q16_GRID_ROWS;
+        cellStart.assign(numCells + 1, 0);
+        cellOf.resize(count);
+        sortedIndex.resize(count);
+        sortedX.resize(count);
+        sortedY.resize(count);
+
+        for (int i = 0; i < count; i++) {
+            int c = cellIndex(x[i], y[i]);
+            cellOf[i] = c;
+            cellStart[c + 1]++;
+        }
+
+        for (int c = 0; c < numCells; c++) cellStart[c + 1] += cellStart[c];
+
+        std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) {
+            int slot = cursor[cellOf[i]]++;
+            sortedIndex[slot] = i;
+            sortedX[slot] = x[i];
+            sortedY[slot] = y[i];
+        }
+
+        const int minDistSq = Q16_MIN_DIST * Q16_MIN_DIST;
+        hitFlags.assign(count, 0);
+
+        for (int cy = 0; cy < Q16_GRID_ROWS; cy++) {
+            for (int cx = 0; cx < Q16_GRID_COLS; cx++) {
+                int c = cy * Q16_GRID_COLS + cx;
+                for (int s = cellStart[c]; s < cellStart[c + 1]; s++) {
+                    if (hitFlags[s]) continue;
+
+                    int hitSlot = findNeighbor(s, cellStart[c], cellStart[c + 1], minDistSq);
+                    for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, Q16_GRID_ROWS - 1) && hitSlot < 0; ny++) {
+                        int rowStart = ny * Q16_GRID_COLS;
+                        int first = cellStart[rowStart + std::max(cx - 1, 0)];
+                        int last = cellStart[rowStart + std::min(cx + 1, Q16_GRID_COLS - 1) + 1];
+
+                        if (ny == cy) {
+                            hitSlot = findNeighbor(s, first, cellStart[c], minDistSq);
+                            if (hitSlot < 0) hitSlot = findNeighbor(s, cellStart[c + 1], last, minDistSq);
+                        }
+                        else {
+                            hitSlot = findNeighbor(s, first, last, minDistSq);
+                        }
+                    }
+
+                    if (hitSlot >= 0) {
+                        hitFlags[s] = 1;
+                        hitFlags[hitSlot] = 1;
+                    }
+                }
+            }
+        }
+
+        for (int s = 0; s < count; s++) {
+            if (!hitFlags[s]) continue;
+            int i = sortedIndex[s];
+            vx[i] = (int16_t)-vx[i];
+            vy[i] = (int16_t)-vy[i];
+        }
+    }
+};
+
+// ==========================================
+// CONTOARE HARDWARE (perf_event_open, --bench --perf)
+// ==========================================
+// Cicluri, instructiuni, miss-uri L1d / LLC / dTLB si branch-uri gresite, numarate
+// doar in user space, pe thread-ul curent. Fiecare contor e deschis separat, nu in
+// grup: daca PMU-ul are mai putine registre, kernelul le multiplexeaza si valorile se
+// scaleaza cu timpul in care contorul chiar a numarat.
+// Un contor care nu se deschide (alt OS, VM fara PMU, perf_event_paranoid prea mare)
+// ramane indisponibil si apare ca "-"; timpii benchmark-ului nu se schimba.
+enum PerfEvent {
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+const char* perfEventName(int e) {
+    static const char* const names[PERF_EVENT_COUNT] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses" };
+    return names[e];
+}
+
+// Valori cumulate (sau diferente / sume de valori cumulate), cate una per eveniment
+struct PerfSample {
+    double value[PERF_EVENT_COUNT] = {};
+};
+
+class PerfCounters {
+private:
+    int fds[PERF_EVENT_COUNT];
+    std::string error; // Primul contor care n-a mers si de ce
+
+#if PERF_COUNTERS
+    static void eventConfig(int e, perf_event_attr& attr) {
+        const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+        case PERF_CYCLES: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PERF_INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PERF_LLC_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break; // Pe x86 = LLC
+        case PERF_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PERF_L1D_MISSES: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss; break;
+        default: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss; break;
+        }
+    }
+#endif
+
+public:
+    PerfCounters() { std::fill(fds, fds + PERF_EVENT_COUNT, -1); }
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // true daca macar un contor numara
+    bool open() {
+        close();
+#if PERF_COUNTERS
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            eventConfig(e, attr);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+            if (fds[e] < 0 && error.empty()) error = std::string(perfEventName(e)) + ": " + strerror(errno);
+        }
+        if (!any()) {
+            std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+            int level = 0;
+            if (paranoid >> level) error += " (perf_event_paranoid = " + std::to_string(level) + ")";
+        }
+#else
+        error = "perf_event_open exista doar pe Linux";
+#endif
+        return any();
+    }
+
+    void close() {
+#if PERF_COUNTERS
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+        error.clear();
+    }
+
+    bool available(int e) const { return fds[e] >= 0; }
+    bool any() const {
+        for (int fd : fds) if (fd >= 0) return true;
+        return false;
+    }
+    const std::string& lastError() const { return error; }
+
+    // Valorile cumulate de la open(), scalate daca contorul a fost multiplexat
+    void read(PerfSample& out) const {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            out.value[e] = 0.0;
+#if PERF_COUNTERS
+            uint64_t raw[3]; // valoare, timp activat, timp numarat
+            if (fds[e] < 0 || ::read(fds[e], raw, sizeof(raw)) != (ssize_t)sizeof(raw) || raw[2] == 0) continue;
+            out.value[e] = (double)raw[0] * ((double)raw[1] / (double)raw[2]);
+#endif
+        }
+    }
+};
+
+// total += end - begin
+void accumulatePerf(PerfSample& total, const PerfSample& begin, const PerfSample& end) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) total.value[e] += end.value[e] - begin.value[e];
+}
+
+double perfIPC(const PerfSample& s) {
+    return s.value[PERF_CYCLES] > 0.0 ? s.value[PERF_INSTRUCTIONS] / s.value[PERF_CYCLES] : 0.0;
+}
+
+// "IPC 1.85 | cycles 4.1 | instructions 7.6 | ..." ("-" = contor indisponibil)
+std::string formatPerf(const PerfCounters& counters, const PerfSample& s) {
+    std::string out = "IPC ";
+    out += counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS) ? std::to_string(perfIPC(s)) : "-";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        out += std::string(" | ") + perfEventName(e) + " ";
+        out += counters.available(e) ? std::to_string(s.value[e]) : "-";
+    }
+    return out;
+}
+
+// ==========================================
+// BENCHMARK HEADLESS (--bench)
+// ==========================================
+// Rulare fara fereastra: baleiaza numarul de entitati, padding-ul si layout-ul,
+// cu seed fix si warmup, si scrie mediana / p99 in ns per entitate.
+//
+//   main --bench [--counts 1000,100000] [--paddings 0,4000] [--layouts aos,soa,aosoa8,aosoa16,hotcold,q16]
+//                [--frames 60] [--warmup 10] [--seed 1234] [--collision-max 4096] [--max-mb 2048]
+//                [--simd scalar|sse2|avx2|avx512] [--broadphase brute|grid] [--verify] [--perf]
+//                [--csv bench_phase1.csv] [--json bench_phase1.json]
+//
+// --perf adauga contoarele hardware ale update-ului si coliziunii (pe frame-urile
+// masurate): IPC si cicluri / instructiuni / miss-uri per entitate per frame.
+
+// Valorile de padding compilate (sizeof(ParticleOOP) = 16 + padding)
+const int BENCH_PADDINGS[] = { 0, 48, 240, 1008, 4000 };
+
+struct BenchConfig {
+    std::vector<int> counts = { 1000, 10000, 100000, 1000000, 10000000 };
+    std::vector<int> paddings = { 0, 48, 240, 1008, 4000 };
+    std::vector<std::string> layouts = { "aos", "soa", "aosoa8", "aosoa16", "hotcold", "q16" };
+    SimdLevel simd = SIMD_SCALAR; // Kernel-ul folosit de layout-urile "soa" si "q16"
+    BroadphaseMode broadphase = BROADPHASE_BRUTE; // "soa" si "q16"; cu grid coliziunea merge la orice count
+    bool verify = false; // Compara grid-ul cu brute force si q16 cu float inainte de benchmark
+    bool perf = false;   // --perf
+    const PerfCounters* counters = nullptr; // Deschise de runBenchmark daca merg
+    int frames = 60;
+    int warmup = 10;
+    unsigned int seed = 1234;
+    int collisionMax = 4096;   // Coliziunea brute force e O(n^2), o masuram doar sub pragul asta
+    long long maxMB = 2048;    // Sarim configuratiile care nu incap in memorie
+    std::string csvPath = "bench_phase1.csv";
+    std::string jsonPath = "bench_phase1.json";
+};
+
+struct BenchResult {
+    std::string layout;
+    int padding = 0;
+    int count = 0;
+    int frames = 0;
+    double updateMedian = 0, updateP99 = 0;       // ns / entitate
+    bool hasCollision = false;
+    double collisionMedian = 0, collisionP99 = 0; // ns / entitate
+    bool hasPerf = false;
+    PerfSample updatePerf, collisionPerf;         // Per entitate per frame
+};
+
+double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t idx = (size_t)(p * (samples.size() - 1) + 0.5);
+    return samples[std::min(idx, samples.size() - 1)];
+}
+
+double elapsedNs(Uint64 start, Uint64 end) {
+    return (double)(end - start) * 1e9 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Wrapper AoS peste ParticleOOP, ca sa aiba aceeasi interfata ca sistemele DOD
+template <int PADDING>
+struct ParticleSystemAoS {
+    std::vector<ParticleOOP<PADDING>> particles;
+
+    void init(int num) {
+        particles.clear();
+        particles.resize(num);
+    }
+
+    void update(float deltaTime) {
+        for (size_t i = 0; i < particles.size(); i++) particles[i].update(deltaTime);
+    }
+
+    void checkCollisions() {
+        for (size_t i = 0; i < particles.size(); i++) particles[i].checkCollision(particles, (int)i);
+    }
+};
+
+// Doar ParticleSystemDOD si Q16 au kernel-uri SIMD si broadphase cu grid;
+// restul layout-urilor raman pe varianta scalara O(n^2)
+template <typename System>
+void configureSystem(System&, const BenchConfig&) {}
+
+void configureSystem(ParticleSystemDOD& sys, const BenchConfig& cfg) {
+    sys.kernel = selectUpdateKernel(cfg.simd);
+    sys.broadphase = cfg.broadphase;
+}
+
+void configureSystem(ParticleSystemQ16& sys, const BenchConfig& cfg) {
+    sys.kernel = selectQ16Kernel(cfg.simd);
+    sys.broadphase = cfg.broadphase;
+}
+
+template <typename System>
+bool usesGrid(const System&) { return false; }
+
+bool usesGrid(const ParticleSystemDOD& sys) { return sys.broadphase == BROADPHASE_GRID; }
+bool usesGrid(const ParticleSystemQ16& sys) { return sys.broadphase == BROADPHASE_GRID; }
+
+template <typename System>
+BenchResult benchSystem(const BenchConfig& cfg, const std::string& layout, int padding, int count) {
+    BenchResult res;
+    res.layout = layout;
+    res.padding = padding;
+    res.count = count;
+    res.frames = cfg.frames;
+
+    // Seed fix: toate layout-urile pornesc din aceeasi stare
+    srand(cfg.seed);
+    System sys;
+    sys.init(count);
+    configureSystem(sys, cfg);
+    res.hasCollision = count <= cfg.collisionMax || usesGrid(sys);
+
+    // Datele reci ale layout-urilor non-AoS stau separat si nu sunt atinse in bucla
+    std::vector<char> cold;
+    if (layout != "aos") cold.assign((size_t)count * padding, 'X');
+
+    const float dt = 0.016f;
+    std::vector<double> updateSamples, collisionSamples;
+    updateSamples.reserve(cfg.frames);
+    collisionSamples.reserve(cfg.frames);
+
+    // Contoarele se citesc in afara intervalelor cronometrate
+    res.hasPerf = cfg.counters != nullptr;
+    PerfSample p0, p1, p2;
+
+    for (int f = 0; f < cfg.warmup + cfg.frames; f++) {
+        bool measured = f >= cfg.warmup;
+        if (res.hasPerf && measured) cfg.counters->read(p0);
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        sys.update(dt);
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        if (res.hasPerf && measured) cfg.counters->read(p1);
+        Uint64 t2 = SDL_GetPerformanceCounter();
+        if (res.hasCollision) sys.checkCollisions();
+        Uint64 t3 = SDL_GetPerformanceCounter();
+        if (res.hasPerf && measured) {
+            cfg.counters->read(p2);
+            accumulatePerf(res.updatePerf, p0, p1);
+            accumulatePerf(res.collisionPerf, p1, p2);
+        }
+
+        if (!measured) continue;
+        updateSamples.push_back(elapsedNs(t0, t1) / count);
+        if (res.hasCollision) collisionSamples.push_back(elapsedNs(t2, t3) / count);
+    }
+
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        res.updatePerf.value[e] /= (double)cfg.frames * count;
+        res.collisionPerf.value[e] /= (double)cfg.frames * count;
+    }
+
+    res.updateMedian = percentile(updateSamples, 0.5);
+    res.updateP99 = percentile(updateSamples, 0.99);
+    if (res.hasCollision) {
+        res.collisionMedian = percentile(collisionSamples, 0.5);
+        res.collisionP99 = percentile(collisionSamples, 0.99);
+    }
+    return res;
+}
+
+bool benchAoS(const BenchConfig& cfg, int padding, int count, BenchResult& out) {
+    switch (padding) {
+    case 0:    out = benchSystem<ParticleSystemAoS<0>>(cfg, "aos", padding, count); return true;
+    case 48:   out = benchSystem<ParticleSystemAoS<48>>(cfg, "aos", padding, count); return true;
+    case 240:  out = benchSystem<ParticleSystemAoS<240>>(cfg, "aos", padding, count); return true;
+    case 1008: out = benchSystem<ParticleSystemAoS<1008>>(cfg, "aos", padding, count); return true;
+    case 4000: out = benchSystem<ParticleSystemAoS<4000>>(cfg, "aos", padding, count); return true;
+    }
+    return false;
+}
+
+bool benchLayout(const BenchConfig& cfg, const std::string& layout, int padding, int count, BenchResult& out) {
+    if (layout == "aos") return benchAoS(cfg, padding, count, out);
+    if (layout == "soa") { out = benchSystem<ParticleSystemDOD>(cfg, layout, padding, count); return true; }
+    if (layout == "aosoa8") { out = benchSystem<ParticleSystemAoSoA<8>>(cfg, layout, padding, count); return true; }
+    if (layout == "aosoa16") { out = benchSystem<ParticleSystemAoSoA<16>>(cfg, layout, padding, count); return true; }
+    if (layout == "hotcold") { out = benchSystem<ParticleSystemHotCold>(cfg, layout, padding, count); return true; }
+    if (layout == "q16") { out = benchSystem<ParticleSystemQ16>(cfg, layout, padding, count); return true; }
+    return false;
+}
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t comma = s.find(',', start);
+        if (comma == std::string::npos) comma = s.size();
+        if (comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+std::vector<int> splitInts(const std::string& s) {
+    std::vector<int> out;
+    for (const std::string& item : splitList(s)) out.push_back(atoi(item.c_str()));
+    return out;
+}
+
+bool parseBenchArgs(int argc, char* args[], BenchConfig& cfg) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg = args[i];
+        if (arg == "--verify") {
+            cfg.verify = true;
+            continue;
+        }
+        if (arg == "--perf") {
+            cfg.perf = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Lipseste valoarea pentru " << arg << std::endl;
+            return false;
+        }
+        std::string value = args[++i];
+
+        if (arg == "--counts") cfg.counts = splitInts(value);
+        else if (arg == "--paddings") cfg.paddings = splitInts(value);
+        else if (arg == "--layouts") cfg.layouts = splitList(value);
+        else if (arg == "--frames") cfg.frames = std::max(1, atoi(value.c_str()));
+        else if (arg == "--warmup") cfg.warmup = std::max(0, atoi(value.c_str()));
+        else if (arg == "--seed") cfg.seed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--collision-max") cfg.collisionMax = atoi(value.c_str());
+        else if (arg == "--max-mb") cfg.maxMB = atoll(value.c_str());
+        else if (arg == "--broadphase") cfg.broadphase = (value == "grid") ? BROADPHASE_GRID : BROADPHASE_BRUTE;
+        else if (arg == "--simd") cfg.simd = std::min(cfg.simd, parseSimdLevel(value.c_str()));
+        else if (arg == "--csv") cfg.csvPath = value;
+        else if (arg == "--json") cfg.jsonPath = value;
+        else {
+            std::cerr << "Argument necunoscut: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    for (int p : cfg.paddings) {
+        if (std::find(std::begin(BENCH_PADDINGS), std::end(BENCH_PADDINGS), p) == std::end(BENCH_PADDINGS)) {
+            std::cerr << "Padding " << p << " nu e compilat (valori posibile: 0, 48, 240, 1008, 4000)" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Coloanele --perf ale unei faze ("update" / "collision"): IPC + fiecare eveniment per
+// entitate; gol pentru contoarele indisponibile
+void writePerfCSVHeader(std::ofstream& out, const char* phase) {
+    out << ',' << phase << "_ipc";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) out << ',' << phase << '_' << perfEventName(e) << "_per_ent";
+}
+
+void writePerfCSV(std::ofstream& out, const PerfCounters& counters, const PerfSample& s, bool measured) {
+    out << ',';
+    if (measured && counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS)) out << perfIPC(s);
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        out << ',';
+        if (measured && counters.available(e)) out << s.value[e];
+    }
+}
+
+void writeBenchCSV(const std::string& path, const BenchConfig& cfg, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << "layout,padding,count,frames,update_median_ns,update_p99_ns,collision_median_ns,collision_p99_ns";
+    if (cfg.counters) {
+        writePerfCSVHeader(out, "update");
+        writePerfCSVHeader(out, "collision");
+    }
+    out << '\n';
+    for (const BenchResult& r : results) {
+        out << r.layout << ',' << r.padding << ',' << r.count << ',' << r.frames << ','
+            << r.updateMedian << ',' << r.updateP99 << ',';
+        if (r.hasCollision) out << r.collisionMedian << ',' << r.collisionP99;
+        else out << ',';
+        if (cfg.counters) {
+            writePerfCSV(out, *cfg.counters, r.updatePerf, r.hasPerf);
+            writePerfCSV(out, *cfg.counters, r.collisionPerf, r.hasPerf && r.hasCollision);
+        }
+        out << '\n';
+    }
+}
+
+// ", \"update_perf\": { \"ipc\": ..., \"cycles_per_ent\": ... }", doar contoarele disponibile
+void writePerfJSON(std::ofstream& out, const PerfCounters& counters, const char* phase, const PerfSample& s) {
+    out << ", \"" << phase << "_perf\": {";
+    bool first = true;
+    if (counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS)) {
+        out << " \"ipc\": " << perfIPC(s);
+        first = false;
+    }
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (!counters.available(e)) continue;
+        out << (first ? " \"" : ", \"") << perfEventName(e) << "_per_ent\": " << s.value[e];
+        first = false;
+    }
+    out << " }";
+}
+
+void writeBenchJSON(const std::string& path, const BenchConfig& cfg, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << "{\n  \"seed\": " << cfg.seed << ",\n  \"warmup\": " << cfg.warmup
+        << ",\n  \"simd\": \"" << simdLevelName(cfg.simd)
+        << "\",\n  \"broadphase\": \"" << (cfg.broadphase == BROADPHASE_GRID ? "grid" : "brute")
+        << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << "    { \"layout\": \"" << r.layout << "\", \"padding\": " << r.padding
+            << ", \"count\": " << r.count << ", \"frames\": " << r.frames
+            << ", \"update_median_ns\": " << r.updateMedian << ", \"update_p99_ns\": " << r.updateP99;
+        if (r.hasCollision) {
+            out << ", \"collision_median_ns\": " << r.collisionMedian << ", \"collision_p99_ns\": " << r.collisionP99;
+        }
+        if (r.hasPerf) {
+            writePerfJSON(out, *cfg.counters, "update", r.updatePerf);
+            if (r.hasCollision) writePerfJSON(out, *cfg.counters, "collision", r.collisionPerf);
+        }
+        out << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Ruleaza ambele broadphase-uri pe aceeasi stare si numara vitezele care difera
+template <typename System>
+bool verifyBroadphase(const BenchConfig& cfg, const char* layout, int count) {
+    srand(cfg.seed);
+    System brute;
+    brute.init(count);
+    System grid = brute;
+    grid.broadphase = BROADPHASE_GRID;
+
+    int mismatches = 0;
+    for (int f = 0; f < 5; f++) {
+        brute.update(0.016f);
+        grid.update(0.016f);
+        brute.checkCollisionsBrute();
+        grid.checkCollisionsGrid();
+        for (int i = 0; i < count; i++) {
+            if (brute.vx[i] != grid.vx[i] || brute.vy[i] != grid.vy[i] ||
+                brute.x[i] != grid.x[i] || brute.y[i] != grid.y[i]) mismatches++;
+        }
+    }
+
+    std::cout << "Verificare grid vs brute force (" << layout << ", " << count << " particule, 5 frame-uri): "
+        << (mismatches == 0 ? "identic" : std::to_string(mismatches) + " diferente") << std::endl;
+    return mismatches == 0;
+}
+
+// Un pas float si un pas q16 din aceeasi stare (cuantizata), fara coliziuni: eroarea
+// maxima de pozitie trebuie sa ramana sub Q16_STEP_ERROR. Dupa fiecare pas starea
+// float e resincronizata, deci masuram eroarea per pas, nu deriva acumulata.
+bool verifyQuantized(const BenchConfig& cfg, int count) {
+    srand(cfg.seed);
+    ParticleSystemDOD ref;
+    ref.init(count);
+    ref.kernel = selectUpdateKernel(cfg.simd);
+    ParticleSystemQ16 q;
+    q.quantizeFrom(ref);
+    q.kernel = selectQ16Kernel(cfg.simd);
+
+    float maxError = 0.0f;
+    for (int f = 0; f < 5; f++) {
+        q.dequantizeTo(ref);
+        ref.update(0.016f);
+        q.update(0.016f);
+        for (int i = 0; i < count; i++) {
+            maxError = std::max(maxError, std::fabs(ref.x[i] - dequantize16(q.x[i])));
+            maxError = std::max(maxError, std::fabs(ref.y[i] - dequantize16(q.y[i])));
+        }
+    }
+
+    bool ok = maxError <= Q16_STEP_ERROR;
+    std::cout << "Verificare q16 vs float (" << count << " particule, 5 pasi): eroare maxima "
+        << maxError << " px / pas (limita " << Q16_STEP_ERROR << ")" << (ok ? "" : " DEPASITA") << std::endl;
+    return ok;
+}
+
+int runBenchmark(int argc, char* args[]) {
+    BenchConfig cfg;
+    cfg.simd = detectSimdLevel();
+    if (!parseBenchArgs(argc, args, cfg)) return 1;
+    std::cout << "SIMD (soa): " << simdLevelName(cfg.simd)
+        << " | Broadphase (soa, q16): " << (cfg.broadphase == BROADPHASE_GRID ? "grid" : "brute") << std::endl;
+
+    PerfCounters counters;
+    if (cfg.perf) {
+        if (counters.open()) cfg.counters = &counters;
+        else std::cout << "Contoare hardware indisponibile (" << counters.lastError() << "), --perf ignorat" << std::endl;
+        if (cfg.counters && !counters.lastError().empty()) std::cout << "Contoare hardware partiale: " << counters.lastError() << std::endl;
+    }
+
+    if (cfg.verify) {
+        for (int count : cfg.counts) {
+            if (count > cfg.collisionMax) continue;
+            if (!verifyBroadphase<ParticleSystemDOD>(cfg, "soa", count)) return 1;
+            if (!verifyBroadphase<ParticleSystemQ16>(cfg, "q16", count)) return 1;
+        }
+        for (int count : cfg.counts) {
+            if ((long long)count * 16 > cfg.maxMB * 1024 * 1024) continue;
+            if (!verifyQuantized(cfg, count)) return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    std::cout << "layout\tpadding\tcount\tupdate med / p99 (ns/ent)\tcollision med / p99 (ns/ent)" << std::endl;
+
+    for (int count : cfg.counts) {
+        for (int padding : cfg.paddings) {
+            long long bytes = (long long)count * (16 + padding);
+            for (const std::string& layout : cfg.layouts) {
+                if (bytes > cfg.maxMB * 1024 * 1024) {
+                    std::cout << layout << " padding=" << padding << " count=" << count
+                        << " sarit (" << bytes / (1024 * 1024) << " MB > --max-mb)" << std::endl;
+                    continue;
+                }
+
+                BenchResult r;
+                if (!benchLayout(cfg, layout, padding, count, r)) {
+                    std::cerr << "Layout necunoscut: " << layout << std::endl;
+                    return 1;
+                }
+                results.push_back(r);
+
+                std::cout << r.layout << "\t" << r.padding << "\t" << r.count << "\t"
+                    << r.updateMedian << " / " << r.updateP99 << "\t";
+                if (r.hasCollision) std::cout << r.collisionMedian << " / " << r.collisionP99;
+                else std::cout << "-";
+                std::cout << std::endl;
+                if (r.hasPerf) {
+                    std::cout << "\tperf update (per entitate): " << formatPerf(counters, r.updatePerf) << std::endl;
+                    if (r.hasCollision) std::cout << "\tperf collision (per entitate): " << formatPerf(counters, r.collisionPerf) << std::endl;
+                }
+            }
+        }
+    }
+
+    if (!cfg.csvPath.empty()) {
+        writeBenchCSV(cfg.csvPath, cfg, results);
+        std::cout << "CSV: " << cfg.csvPath << std::endl;
+    }
+    if (!cfg.jsonPath.empty()) {
+        writeBenchJSON(cfg.jsonPath, cfg, results);
+        std::cout << "JSON: " << cfg.jsonPath << std::endl;
+    }
+    return 0;
+}
+
 // ==========================================
 // MAIN
 // ==========================================
 int main(int argc, char* args[]) {
+    if (argc > 1 && strcmp(args[1], "--bench") == 0) {
+        return runBenchmark(argc, args);
+    }
+
     srand((unsigned int)time(0));
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) { return -1; }
@@ -140,15 +1537,25 @@ int main(int argc, char* args[]) {
 
     // --- CONFIGURARE ---
     bool useDOD = false;        // TAB sa schimbi
-    bool runCollision = false;  // 'C' sa activezi (ATENTIE: Doar la putine particule!)
+    bool runCollision = false;  // 'C' sa activezi (ATENTIE: brute force doar la putine particule!)
+                                // 'G' comuta DOD pe broadphase cu grid (merge si la 200k, si in modul 'Q')
     bool renderEnabled = true;  // 'R' sa opresti desenarea (pt testare CPU pura)
+    bool batchedRender = true;  // 'B': un singur SDL_RenderFillRects vs un apel per particula
+    bool quantized = false;     // 'Q': DOD pe int16 fixed point (jumatate din bytes)
 
     // OOP Setup
-    std::vector<ParticleOOP> particlesOOP(NUM_PARTICULE);
+    std::vector<ParticleOOP<>> particlesOOP(NUM_PARTICULE);
 
     // DOD Setup
+    SimdLevel simdLevel = detectSimdLevel();
     ParticleSystemDOD particlesDOD;
     particlesDOD.init(NUM_PARTICULE);
+    particlesDOD.kernel = selectUpdateKernel(simdLevel);
+    ParticleSystemQ16 particlesQ16;
+    particlesQ16.kernel = selectQ16Kernel(simdLevel);
+
+    // Toate particulele au aceeasi culoare, deci un singur batch de dreptunghiuri
+    std::vector<SDL_Rect> rects;
 
     bool isRunning = true;
     SDL_Event ev;
@@ -163,7 +1570,21 @@ int main(int argc, char* args[]) {
                     runCollision = !runCollision;
                     std::cout << "Collision: " << (runCollision ? "ON" : "OFF") << std::endl;
                 }
+                if (ev.key.keysym.sym == SDLK_g) {
+                    bool grid = particlesDOD.broadphase != BROADPHASE_GRID;
+                    particlesDOD.broadphase = grid ? BROADPHASE_GRID : BROADPHASE_BRUTE;
+                    particlesQ16.broadphase = particlesDOD.broadphase;
+                    std::cout << "Broadphase (DOD): " << (grid ? "GRID" : "BRUTE FORCE") << std::endl;
+                }
                 if (ev.key.keysym.sym == SDLK_r) renderEnabled = !renderEnabled;
+                if (ev.key.keysym.sym == SDLK_b) batchedRender = !batchedRender;
+                if (ev.key.keysym.sym == SDLK_q) {
+                    // Starea trece dintr-o reprezentare in cealalta, particulele nu sar
+                    quantized = !quantized;
+                    if (quantized) particlesQ16.quantizeFrom(particlesDOD);
+                    else particlesQ16.dequantizeTo(particlesDOD);
+                    std::cout << "Storage (DOD): " << (quantized ? "INT16 FIXED POINT" : "FLOAT") << std::endl;
+                }
             }
         }
 
@@ -172,7 +1593,13 @@ int main(int argc, char* args[]) {
 
         float dt = 0.016f; // Delta time fix pentru consistenta testului
 
-        if (useDOD) {
+        if (useDOD && quantized) {
+            particlesQ16.update(dt);
+            if (runCollision) {
+                particlesQ16.checkCollisions();
+            }
+        }
+        else if (useDOD) {
             particlesDOD.update(dt);
             if (runCollision) {
                 particlesDOD.checkCollisions();
@@ -202,7 +1629,35 @@ int main(int argc, char* args[]) {
             rect.w = (int)RAZA_PARTICULA;
             rect.h = (int)RAZA_PARTICULA;
 
-            if (useDOD) {
+            if (batchedRender) {
+                // Umplem buffer-ul (bucla simpla, fara apeluri SDL) si il trimitem o data
+                int count = useDOD ? particlesDOD.count : NUM_PARTICULE;
+                rects.resize(count);
+                if (useDOD && quantized) {
+                    for (int i = 0; i < count; i++) {
+                        rects[i] = { (int)dequantize16(particlesQ16.x[i]), (int)dequantize16(particlesQ16.y[i]), rect.w, rect.h };
+                    }
+                }
+                else if (useDOD) {
+                    for (int i = 0; i < count; i++) {
+                        rects[i] = { (int)particlesDOD.x[i], (int)particlesDOD.y[i], rect.w, rect.h };
+                    }
+                }
+                else {
+                    for (int i = 0; i < count; i++) {
+                        rects[i] = { (int)particlesOOP[i].x, (int)particlesOOP[i].y, rect.w, rect.h };
+                    }
+                }
+                SDL_RenderFillRects(renderer, rects.data(), count);
+            }
+            else if (useDOD && quantized) {
+                for (int i = 0; i < particlesQ16.count; i++) {
+                    rect.x = (int)dequantize16(particlesQ16.x[i]);
+                    rect.y = (int)dequantize16(particlesQ16.y[i]);
+                    SDL_RenderFillRect(renderer, &rect);
+                }
+            }
+            else if (useDOD) {
                 for (int i = 0; i < particlesDOD.count; i++) {
                     rect.x = (int)particlesDOD.x[i];
                     rect.y = (int)particlesDOD.y[i];
@@ -229,11 +1684,14 @@ int main(int argc, char* args[]) {
 
             // Calculam si FPS-ul real (pentru curiozitate)
             // timeMs este timpul strict pentru Update (matematica)
-            std::string title = std::string(useDOD ? "Mode: [ DOD ]" : "Mode: [ OOP ]") +
+            std::string title = std::string(useDOD ? "Mode: [ DOD " : "Mode: [ OOP ]") +
+                (useDOD ? std::string(simdLevelName(simdLevel)) + " ]" : "") +
                 " | Objects: " + std::to_string(NUM_PARTICULE) +
                 " | UPDATE TIME: " + std::to_string(timeMs) + " ms" +
                 (runCollision ? " [COLLISION ON]" : "") +
-                (renderEnabled ? "" : " [NO RENDER]");
+                (useDOD && quantized ? " [INT16]" : "") +
+                (useDOD && particlesDOD.broadphase == BROADPHASE_GRID ? " [GRID]" : "") +
+                (renderEnabled ? (batchedRender ? " [BATCH]" : " [PER-RECT]") : " [NO RENDER]");
 
             SDL_SetWindowTitle(window, title.c_str());
         }
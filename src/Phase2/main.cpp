@@ -2,310 +2,4742 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <fstream>
 #include <random>
 #include <ctime>
 #include <algorithm>
 #include <thread>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <type_traits>
+#include <cassert>
+
+// mmap pentru snapshot-urile binare (StateFile)
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Contoare hardware pentru --headless --perf (perf_event_open exista doar pe Linux)
+#if defined(__linux__)
+#define PERF_COUNTERS 1
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <cerrno>
+#else
+#define PERF_COUNTERS 0
+#endif
+
+// --- FARA FMA ---
+// Contopirea mul + add intr-un FMA depinde de compilator si de flag-uri (-march=native o
+// face si in codul scalar), deci kernel-ele pe ISA-uri diferite ar rotunji diferit.
+// O oprim pentru tot fisierul: fiecare varianta SIMD da acelasi rezultat ca cea scalara.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
 
 // --- CONSTANTE JOC ---
 const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
-const int MAX_ENTITIES = 20000;
+const int MAX_ENTITIES = 20000; // Capacitatea initiala a Registry (creste la nevoie)
+
+// --- CONSTANTE LUME ---
+// Lumea are WORLD_SCREENS x WORLD_SCREENS ecrane (--world N); fereastra e doar o camera
+// peste ea. Numarul de entitati pe ecran ramane acelasi la orice marime a lumii.
+const int DEFAULT_WORLD_SCREENS = 1; // Jocul normal: un ecran; lumea mare e doar la cerere
+const int MAX_WORLD_SCREENS = 100;   // ~10M entitati; indexul de 24 de biti nu duce mult peste
+const int ENEMIES_PER_SCREEN = 30;
+const int COINS_PER_SCREEN = 1000;
+
+// --- CONSTANTE SIMULARE ---
+// Pas fix: rezultatul nu depinde de FPS, iar un frame lent nu face un pas urias (tunneling).
+// Dupa o pauza lunga se fac cel mult MAX_CATCHUP_STEPS pasi, restul timpului se pierde.
+const float SIM_DT = 1.0f / 60.0f;
+const int MAX_CATCHUP_STEPS = 5;
 
 // --- CONSTANTE GRID ---
+// Doar marimea celulei: grid-ul e un spatial hash, fara numar fix de coloane / randuri
 const int CELL_SIZE = 64;
-const int GRID_COLS = (WINDOW_WIDTH / CELL_SIZE) + 1;
-const int GRID_ROWS = (WINDOW_HEIGHT / CELL_SIZE) + 1;
-const int MAX_CELLS = GRID_COLS * GRID_ROWS;
 
-extern "C" {
-    __declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
-    __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
-}
+// Broadphase-ul coliziunilor din Gameplay ('G' / --broadphase grid|sweep)
+enum BroadphaseMode { BROADPHASE_GRID, BROADPHASE_SWEEP };
+
+// Grupuri de entitati la initializare (--clusters N): raza unui grup
+const float CLUSTER_RADIUS = 400.0f;
+
+#ifdef _WIN32
+// Cere GPU-ul dedicat pe laptop-uri cu grafica hibrida (doar Windows)
+extern "C" {
+    __declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+    __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
+}
+#endif
+
+float randomFloat(float min, float max) {
+    return min + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (max - min)));
+}
+
+// --- RNG COUNTER-BASED (fara stare) ---
+// rand() are stare globala: apelat din mai multe thread-uri e data race si rezultatul
+// depinde de ordinea thread-urilor. Aici numarul e o functie pura de
+// (seed, frame, entitate, axa): acelasi rezultat pentru orice numar de thread-uri
+// sau impartire pe bucati, si doar operatii pe 32 de biti, deci bucla se vectorizeaza.
+inline uint32_t hashMix(uint32_t h) {
+    // lowbias32 (avalanche bun, bijectiv)
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return h;
+}
+
+// Cheia se calculeaza o data pe frame; fiecare entitate foloseste apoi un singur hash
+inline uint32_t frameKey(uint32_t seed, uint32_t frame) {
+    return hashMix(seed ^ hashMix(frame + 0x9E3779B9U));
+}
+
+inline float counterRandom(uint32_t key, uint32_t counter, float min, float max) {
+    float unit = (float)(hashMix(key ^ counter) >> 8) * (1.0f / 16777216.0f); // [0, 1)
+    return min + unit * (max - min);
+}
+
+// ==========================================
+// SIMD: memorie aliniata + detectie ISA la runtime
+// ==========================================
+inline void* alignedAlloc(size_t bytes, size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0) return nullptr;
+    return p;
+#endif
+}
+
+inline void alignedFree(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// Allocator pentru std::vector: inceputul fiecarui array e pe linie de cache (64),
+// deci load-urile SIMD aliniate si impartirea pe thread-uri pornesc de la o granita curata.
+template <typename T, size_t ALIGN = 64>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef AlignedAllocator<U, ALIGN> other; };
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, ALIGN>&) {}
+
+    T* allocate(size_t n) {
+        void* p = alignedAlloc(n * sizeof(T), ALIGN);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) { alignedFree(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, ALIGN>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, ALIGN>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Granita de bucata pentru parallelFor: 64 de randuri incep o linie de cache noua in
+// orice coloana aliniata la 64 (elementele au cel putin un byte), deci thread-urile
+// vecine nu scriu in aceeasi linie (false sharing)
+const int CACHE_LINE_ROWS = 64;
+
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 };
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_SSE2: return "SSE2";
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+SimdLevel parseSimdLevel(const char* name) {
+    if (strcmp(name, "avx512") == 0) return SIMD_AVX512;
+    if (strcmp(name, "avx2") == 0) return SIMD_AVX2;
+    if (strcmp(name, "sse2") == 0) return SIMD_SSE2;
+    return SIMD_SCALAR;
+}
+
+#if defined(SIMD_X86)
+// FMA e oprit pentru tot fisierul (sus), deci si aici
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+inline void cpuidQuery(int out[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    out[0] = (int)a; out[1] = (int)b; out[2] = (int)c; out[3] = (int)d;
+#endif
+}
+
+inline unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+// CPUID + XGETBV (OS-ul trebuie sa salveze si registrii YMM/ZMM)
+SimdLevel detectSimdLevel() {
+#if defined(SIMD_X86)
+    int info[4];
+    cpuidQuery(info, 0, 0);
+    int maxLeaf = info[0];
+
+    cpuidQuery(info, 1, 0);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!sse2) return SIMD_SCALAR;
+    if (!osxsave || !avx || maxLeaf < 7) return SIMD_SSE2;
+
+    unsigned long long xcr0 = xgetbv0();
+    bool osYmm = (xcr0 & 0x6) == 0x6;
+    bool osZmm = (xcr0 & 0xE6) == 0xE6;
+
+    cpuidQuery(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool avx512f = (info[1] & (1 << 16)) != 0;
+
+    if (avx512f && osZmm) return SIMD_AVX512;
+    if (avx2 && osYmm) return SIMD_AVX2;
+    return SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// ==========================================
+// 1. COMPONENTE
+// ==========================================
+// Componentele (x, y) sunt stocate in tabelele de arhetip dupa ComponentLayout (implicit SoA)
+// Pozitiile raman float: lumea (--world pana la MAX_WORLD_SCREENS) nu incape in int16 /
+// float16 cu precizie de sub-pixel, ca modul q16 din Phase1
+struct TransformComponent { float x, y; };
+struct VelocityComponent { float vx, vy; };
+struct BoundsComponent { float maxX, maxY; };  // Marginea pentru bounce (fereastra - sprite)
+struct JiggleComponent { float amplitude; };   // Tremuratul monedelor
+struct SpriteComponent { Uint8 r, g, b; int w, h; };
+enum EntityType { TYPE_NONE, TYPE_PLAYER, TYPE_ENEMY, TYPE_COIN };
+struct ColliderComponent { float radius; EntityType type; };
+// Vizibilitatea si coliziunea se opresc cu tag-uri, nu cu bool-uri in componente: entitatea
+// trece in alt arhetip, iar query-urile sar tabelul intreg (fara branch per entitate)
+struct HiddenComponent {};                     // Tag: nu se deseneaza
+struct InactiveComponent {};                   // Tag: ignorata de coliziuni / interogari
+struct SteeringComponent {};                   // Tag: inamicii care se misca in stol (SteeringSystem)
+struct RestComponent { uint32_t quietSteps; }; // Pasi consecutivi fara impingere (somn, --sleep)
+struct SleepingComponent {};                   // Tag: moneda adormita (sarita de jiggle / grid)
+
+enum ComponentBit : uint32_t {
+    COMP_TRANSFORM = 1U << 0,
+    COMP_VELOCITY = 1U << 1,
+    COMP_BOUNDS = 1U << 2,
+    COMP_JIGGLE = 1U << 3,
+    COMP_SPRITE = 1U << 4,
+    COMP_COLLIDER = 1U << 5,
+    COMP_HIDDEN = 1U << 6,    // Doar tag, fara coloana
+    COMP_INACTIVE = 1U << 7,  // Doar tag, fara coloana
+    COMP_STEERING = 1U << 8,  // Doar tag, fara coloana
+    COMP_REST = 1U << 9,
+    COMP_SLEEPING = 1U << 10  // Doar tag, fara coloana
+};
+
+// ==========================================
+// 2. REGISTRY (ARHETIPURI)
+// ==========================================
+// Entity = handle stabil: index de slot (24 biti) + generatie (8 biti). Slot-urile
+// eliberate se refolosesc (free list), iar generatia creste la fiecare distrugere,
+// deci un handle vechi e detectat (locate -> null) in loc sa atinga alta entitate.
+// Cu 8 biti generatia s-ar intoarce la 0 dupa 256 de refolosiri si un handle vechi
+// ar deveni iar valid: cand ajunge la ENTITY_GENERATION_MASK slot-ul e retras (nu mai
+// intra in free list), deci un slot are cel mult 255 de vieti. Generatia 0xFF nu e
+// deci niciodata vie, iar INVALID_ENTITY (slot 0xFFFFFF, generatia 0xFF) nu poate fi
+// handle-ul unei entitati.
+//
+// Entitatile cu acelasi set de componente stau in acelasi Archetype, dens:
+// [0, count) sunt exact entitatile vii, iar la distrugere ultima entitate ia locul
+// celei sterse (swap-and-pop). Un arhetip aloca doar coloanele componentelor lui,
+// deci monedele (fara Velocity) nu apar deloc in integrare, iar inamicii se parcurg
+// contiguu, fara branch-uri pe tip / vizibilitate.
+typedef uint32_t Entity;
+const Entity INVALID_ENTITY = 0xFFFFFFFFU;
+const int ENTITY_INDEX_BITS = 24;
+const uint32_t ENTITY_INDEX_MASK = (1U << ENTITY_INDEX_BITS) - 1;
+const uint32_t ENTITY_GENERATION_MASK = 0xFFU;
+
+// --- ARENA PENTRU COLOANE ---
+// Toate coloanele Registry-ului vin dintr-o singura rezervare de memorie virtuala,
+// impartita in ARENA_SPANS intervale egale, fiecare aliniat la 2 MB (o pagina mare).
+// O coloana primeste un interval intreg la prima alocare si apoi creste pe loc: fara
+// copiere la grow, iar paginile fizice apar doar cand sunt atinse. Pe Linux arena
+// poate cere pagini mari: transparente (madvise MADV_HUGEPAGE) sau explicite
+// (MAP_HUGETLB, din pool-ul rezervat in /proc/sys/vm/nr_hugepages). Mai putine
+// intrari TLB pentru coloanele mari parcurse liniar. Paginile transparente se cer doar
+// pentru intervalul unei coloane care a ajuns la 2 MB: o coloana de cateva sute de KB
+// ar ocupa altfel o pagina mare intreaga (lumea implicita ar lua ~100 MB in loc de KB).
+// Daca rezervarea nu reuseste (32 de biti, limita de memorie) sau o coloana depaseste
+// intervalul, coloana ramane pe heap aliniat ca inainte.
+enum HugePageMode { HUGEPAGES_OFF, HUGEPAGES_TRANSPARENT, HUGEPAGES_EXPLICIT };
+
+HugePageMode parseHugePageMode(const char* s) {
+    if (strcmp(s, "off") == 0) return HUGEPAGES_OFF;
+    if (strcmp(s, "explicit") == 0) return HUGEPAGES_EXPLICIT;
+    return HUGEPAGES_TRANSPARENT;
+}
+
+const char* hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+    case HUGEPAGES_OFF: return "off";
+    case HUGEPAGES_EXPLICIT: return "explicit";
+    default: return "thp";
+    }
+}
+
+struct ArenaConfig {
+    HugePageMode hugePages = HUGEPAGES_TRANSPARENT;
+    size_t maxRows = 1 << 20; // Randuri per tabel care incap in interval
+};
+
+class ComponentArena {
+private:
+    static const size_t HUGE_PAGE = 2 * 1024 * 1024;
+    static const size_t MAX_ELEMENT = 16;   // Intervalul e dimensionat pt cel mai mare tip de coloana
+    static const int ARENA_SPANS = 64;
+
+    char* base = nullptr;
+    size_t spanBytes = 0;
+    size_t maxElements = 0;
+    int usedSpans = 0;
+    int hugeSpans = 0;
+    bool advised[ARENA_SPANS] = {};
+    bool exhaustedReported = false;
+    HugePageMode mode = HUGEPAGES_OFF;
+
+    void unmap() {
+        if (!base) return;
+#if defined(_WIN32)
+        VirtualFree(base, 0, MEM_RELEASE);
+#else
+        munmap(base, spanBytes * ARENA_SPANS);
+#endif
+        base = nullptr;
+    }
+
+public:
+    ComponentArena() {}
+    ~ComponentArena() { unmap(); }
+    ComponentArena(const ComponentArena&) = delete;
+    ComponentArena& operator=(const ComponentArena&) = delete;
+
+    // Elibereaza tot (coloanele vechi trebuie sa fi disparut) si rezerva din nou
+    bool init(const ArenaConfig& cfg) {
+        unmap();
+        usedSpans = hugeSpans = 0;
+        std::fill(advised, advised + ARENA_SPANS, false);
+        if (sizeof(void*) < 8) return false; // Fara spatiu virtual pentru rezervare
+
+        // x2: AoS / AoSoA tin doua float-uri pe rand in aceeasi coloana
+        maxElements = cfg.maxRows * 2 + 64;
+        spanBytes = (maxElements * MAX_ELEMENT + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        size_t total = spanBytes * ARENA_SPANS;
+        mode = cfg.hugePages;
+
+#if defined(_WIN32)
+        // Paginile mari pe Windows cer privilegiul SeLockMemory: doar pagini normale
+        mode = HUGEPAGES_OFF;
+        base = static_cast<char*>(VirtualAlloc(nullptr, total, MEM_RESERVE, PAGE_READWRITE));
+#else
+        void* p = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        if (mode == HUGEPAGES_EXPLICIT) {
+            p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p == MAP_FAILED) {
+                std::cerr << "Arena: MAP_HUGETLB a esuat (pool prea mic pt " << total / HUGE_PAGE
+                    << " pagini de 2 MB), folosesc pagini transparente" << std::endl;
+                mode = HUGEPAGES_TRANSPARENT;
+            }
+        }
+#endif
+        if (p == MAP_FAILED) {
+            if (mode == HUGEPAGES_EXPLICIT) mode = HUGEPAGES_TRANSPARENT;
+            // Rezervare cu 2 MB in plus, ca inceputul sa poata fi aliniat la o pagina mare
+            size_t padded = total + HUGE_PAGE;
+            p = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (p != MAP_FAILED) {
+                uintptr_t start = (uintptr_t)p;
+                uintptr_t aligned = (start + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+                if (aligned > start) munmap(p, aligned - start);
+                if (aligned + total < start + padded) munmap((void*)(aligned + total), start + padded - aligned - total);
+                p = (void*)aligned;
+#if defined(MADV_HUGEPAGE)
+                // Si cu THP "always": intervalele primesc MADV_HUGEPAGE pe rand, in grow()
+                madvise(p, total, MADV_NOHUGEPAGE);
+#endif
+            }
+        }
+        base = p == MAP_FAILED ? nullptr : static_cast<char*>(p);
+#endif
+        return base != nullptr;
+    }
+
+    bool active() const { return base != nullptr; }
+    HugePageMode hugePages() const { return mode; }
+    size_t reservedBytes() const { return base ? spanBytes * ARENA_SPANS : 0; }
+    int spansInUse() const { return usedSpans; }
+    int hugeSpansInUse() const { return hugeSpans; }
+
+    // Cate elemente de `elementSize` bytes incap intr-un interval
+    size_t spanElements(size_t elementSize) const {
+        return elementSize <= MAX_ELEMENT ? maxElements : 0;
+    }
+
+    // Un interval nou, aliniat la 2 MB; null daca arena e inactiva sau plina
+    void* takeSpan() {
+        if (!base) return nullptr;
+        if (usedSpans >= ARENA_SPANS) {
+            if (!exhaustedReported) {
+                std::cerr << "Arena: toate cele " << ARENA_SPANS << " de intervale sunt folosite, coloanele noi merg pe heap" << std::endl;
+                exhaustedReported = true;
+            }
+            return nullptr;
+        }
+        return base + spanBytes * (size_t)usedSpans++;
+    }
+
+    // Pe Windows rezervarea trebuie confirmata inainte de scriere; pe Linux paginile
+    // apar la prima atingere
+    bool commit(void* p, size_t bytes) {
+#if defined(_WIN32)
+        return bytes == 0 || VirtualAlloc(p, bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+        (void)p;
+        (void)bytes;
+        return true;
+#endif
+    }
+
+    // Coloana din intervalul care incepe la `span` foloseste acum `bytes`: de la 2 MB
+    // in sus intervalul primeste pagini mari (doar modul thp; o data per interval)
+    void grow(void* span, size_t bytes) {
+#if defined(MADV_HUGEPAGE)
+        if (mode != HUGEPAGES_TRANSPARENT || bytes < HUGE_PAGE) return;
+        size_t index = (size_t)(static_cast<char*>(span) - base) / spanBytes;
+        if (advised[index]) return;
+        advised[index] = true;
+        hugeSpans++;
+        madvise(base + index * spanBytes, spanBytes, MADV_HUGEPAGE);
+#else
+        (void)span;
+        (void)bytes;
+#endif
+    }
+};
+
+// Memoria procesului in pagini mari transparente (Linux); -1 daca nu se poate citi
+long anonHugePagesKB() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) return atol(line.c_str() + 14);
+    }
+    return -1;
+}
+
+// Coloana dintr-un tabel de arhetip: array aliniat la 64 (ca AlignedVector), luat
+// dintr-un interval al arenei (daca are una) sau de pe heap. Poate si sa imprumute
+// memorie externa, de ex. un snapshot mapat cu mmap: asa un snapshot se incarca fara
+// nicio copiere; prima crestere peste capacitate muta coloana in arena / pe heap.
+template <typename T>
+class Column {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "Coloanele se copiaza cu memcpy");
+
+    enum Storage { STORAGE_NONE, STORAGE_HEAP, STORAGE_ARENA, STORAGE_EXTERNAL };
+
+    T* ptr = nullptr;
+    size_t len = 0;
+    size_t cap = 0;
+    size_t touched = 0; // In arena: elementele de dupa sunt inca pagini neatinse (zero)
+    Storage storage = STORAGE_NONE;
+    ComponentArena* arena = nullptr;
+
+    void release() {
+        if (storage == STORAGE_HEAP) alignedFree(ptr);
+        ptr = nullptr;
+        len = cap = touched = 0;
+        storage = STORAGE_NONE;
+    }
+
+public:
+    Column() {}
+    ~Column() { release(); }
+    Column(const Column&) = delete;
+    Column& operator=(const Column&) = delete;
+
+    void bindArena(ComponentArena* a) { arena = a; }
+
+    // Elementele noi sunt zero, ca la std::vector
+    void resize(size_t n) {
+        if (n > cap) {
+            T* grown = nullptr;
+            size_t grownCap = n;
+            Storage kind = STORAGE_HEAP;
+            // Un singur interval per coloana: dupa ce l-a depasit, coloana trece pe heap
+            if (arena && storage != STORAGE_ARENA && n <= arena->spanElements(sizeof(T))) {
+                grown = static_cast<T*>(arena->takeSpan());
+                if (grown) {
+                    grownCap = arena->spanElements(sizeof(T));
+                    kind = STORAGE_ARENA;
+                }
+            }
+            if (!grown) grown = static_cast<T*>(alignedAlloc(n * sizeof(T), 64));
+            if (!grown) throw std::bad_alloc();
+            if (kind == STORAGE_ARENA && !arena->commit(grown, n * sizeof(T))) throw std::bad_alloc();
+            if (len > 0) memcpy(grown, ptr, len * sizeof(T));
+            size_t keep = len;
+            release();
+            ptr = grown;
+            len = touched = keep;
+            cap = grownCap;
+            storage = kind;
+        }
+        else if (storage == STORAGE_ARENA && n > len && !arena->commit(ptr + len, (n - len) * sizeof(T))) {
+            throw std::bad_alloc();
+        }
+
+        if (storage == STORAGE_ARENA && n > len) arena->grow(ptr, n * sizeof(T));
+
+        if (n > len) {
+            // Paginile noi din arena sunt deja zero: nu le atingem (raman nealocate)
+            size_t clearEnd = storage == STORAGE_ARENA ? std::min(n, touched) : n;
+            if (clearEnd > len) memset(ptr + len, 0, (clearEnd - len) * sizeof(T));
+        }
+        len = n;
+        touched = std::max(touched, n);
+    }
+
+    // Foloseste `external` (n elemente, aliniat) fara copiere; memoria trebuie sa
+    // traiasca cat timp coloana o foloseste
+    void adopt(T* external, size_t n) {
+        release();
+        ptr = external;
+        len = cap = touched = n;
+        storage = STORAGE_EXTERNAL;
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return len; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// --- LAYOUT-URI PENTRU COMPONENTELE (x, y) ---
+// Transform / Velocity / Bounds sunt perechi de float-uri; politica de layout alege
+// cum stau in tabel, la compilare (ca ParticleSystemAoS / DOD / AoSoA din Phase1):
+//  - LayoutSoA:          x[] si y[] separate
+//  - LayoutAoS:          {x, y} intercalate
+//  - LayoutAoSoA<LANES>: blocuri de LANES x-uri urmate de LANES y-uri
+// Sistemele folosesc doar accesorii x(i) / y(i) si, pentru kernel-ele SIMD, lanes(i):
+// cate randuri de la i au x-urile si y-urile contigue (0 = intercalat, doar accesori).
+// Fiecare storage e facut din 1 sau 2 blocuri de float-uri (Column), pe care le
+// folosesc StateFile si storePrevious.
+struct LayoutSoA {};
+struct LayoutAoS {};
+template <int LANES> struct LayoutAoSoA {};
+
+template <typename Layout> class Vec2Storage;
+
+template <>
+class Vec2Storage<LayoutSoA> {
+private:
+    Column<float> xs, ys;
+
+public:
+    static const int BLOCKS = 2;
+    static const uint32_t LAYOUT_ID = 0;   // Salvat in snapshot-uri
+    static const char* name() { return "SoA"; }
+    static size_t blockFloats(size_t rows) { return rows; }
+
+    void bindArena(ComponentArena* a) { xs.bindArena(a); ys.bindArena(a); }
+    void resize(size_t rows) { xs.resize(rows); ys.resize(rows); }
+    size_t size() const { return xs.size(); }
+
+    float& x(size_t i) { return xs[i]; }
+    float& y(size_t i) { return ys[i]; }
+    float x(size_t i) const { return xs[i]; }
+    float y(size_t i) const { return ys[i]; }
+
+    size_t lanes(size_t) const { return SIZE_MAX; }
+    float* xPtr(size_t i) { return xs.data() + i; }
+    float* yPtr(size_t i) { return ys.data() + i; }
+    const float* xPtr(size_t i) const { return xs.data() + i; }
+    const float* yPtr(size_t i) const { return ys.data() + i; }
+
+    float* block(int b) { return b == 0 ? xs.data() : ys.data(); }
+    const float* block(int b) const { return b == 0 ? xs.data() : ys.data(); }
+    void adoptBlock(int b, float* external, size_t rows) { (b == 0 ? xs : ys).adopt(external, rows); }
+};
+
+template <>
+class Vec2Storage<LayoutAoS> {
+private:
+    Column<float> xy;
+
+public:
+    static const int BLOCKS = 1;
+    static const uint32_t LAYOUT_ID = 1;
+    static const char* name() { return "AoS"; }
+    static size_t blockFloats(size_t rows) { return rows * 2; }
+
+    void bindArena(ComponentArena* a) { xy.bindArena(a); }
+    void resize(size_t rows) { xy.resize(rows * 2); }
+    size_t size() const { return xy.size() / 2; }
+
+    float& x(size_t i) { return xy[i * 2]; }
+    float& y(size_t i) { return xy[i * 2 + 1]; }
+    float x(size_t i) const { return xy[i * 2]; }
+    float y(size_t i) const { return xy[i * 2 + 1]; }
+
+    size_t lanes(size_t) const { return 0; }
+    float* xPtr(size_t i) { return &xy[i * 2]; }
+    float* yPtr(size_t i) { return &xy[i * 2 + 1]; }
+    const float* xPtr(size_t i) const { return &xy[i * 2]; }
+    const float* yPtr(size_t i) const { return &xy[i * 2 + 1]; }
+
+    float* block(int) { return xy.data(); }
+    const float* block(int) const { return xy.data(); }
+    void adoptBlock(int, float* external, size_t rows) { xy.adopt(external, blockFloats(rows)); }
+};
+
+template <int LANES>
+class Vec2Storage<LayoutAoSoA<LANES>> {
+private:
+    static_assert(LANES > 0 && (LANES & (LANES - 1)) == 0, "LANES trebuie sa fie putere a lui 2");
+    Column<float> blocks; // Blocul b: x[LANES], y[LANES]
+    size_t rows = 0;
+
+    static size_t offset(size_t i) { return (i / LANES) * 2 * LANES + (i % LANES); }
+
+public:
+    static const int BLOCKS = 1;
+    static const uint32_t LAYOUT_ID = 100 + LANES;
+    static const char* name() { return LANES == 4 ? "AoSoA4" : LANES == 8 ? "AoSoA8" : LANES == 16 ? "AoSoA16" : "AoSoA"; }
+    static size_t blockFloats(size_t rows) { return (rows + LANES - 1) / LANES * 2 * LANES; }
+
+    void bindArena(ComponentArena* a) { blocks.bindArena(a); }
+    void resize(size_t n) {
+        blocks.resize(blockFloats(n));
+        rows = n;
+    }
+    size_t size() const { return rows; }
+
+    float& x(size_t i) { return blocks[offset(i)]; }
+    float& y(size_t i) { return blocks[offset(i) + LANES]; }
+    float x(size_t i) const { return blocks[offset(i)]; }
+    float y(size_t i) const { return blocks[offset(i) + LANES]; }
+
+    size_t lanes(size_t i) const { return LANES - i % LANES; }
+    float* xPtr(size_t i) { return blocks.data() + offset(i); }
+    float* yPtr(size_t i) { return blocks.data() + offset(i) + LANES; }
+    const float* xPtr(size_t i) const { return blocks.data() + offset(i); }
+    const float* yPtr(size_t i) const { return blocks.data() + offset(i) + LANES; }
+
+    float* block(int) { return blocks.data(); }
+    const float* block(int) const { return blocks.data(); }
+    void adoptBlock(int, float* external, size_t n) {
+        blocks.adopt(external, blockFloats(n));
+        rows = n;
+    }
+};
+
+// Layout-ul fiecarei componente; implicit PHASE2_LAYOUT (ex. -DPHASE2_LAYOUT=LayoutAoSoA<8>).
+// Se poate specializa pe componenta / platforma, sistemele nu se schimba:
+//   template <> struct ComponentLayout<BoundsComponent> { typedef LayoutAoS type; };
+#ifndef PHASE2_LAYOUT
+#define PHASE2_LAYOUT LayoutSoA
+#endif
+
+template <typename C> struct ComponentLayout { typedef PHASE2_LAYOUT type; };
+
+typedef Vec2Storage<ComponentLayout<TransformComponent>::type> TransformStorage;
+typedef Vec2Storage<ComponentLayout<VelocityComponent>::type> VelocityStorage;
+typedef Vec2Storage<ComponentLayout<BoundsComponent>::type> BoundsStorage;
+
+// Cate randuri de la `i` sunt contigue in toate storage-urile (0 = unul e intercalat)
+template <typename S>
+size_t commonLanes(size_t i, const S& s) { return s.lanes(i); }
+
+template <typename S, typename... Rest>
+size_t commonLanes(size_t i, const S& s, const Rest&... rest) {
+    return std::min(s.lanes(i), commonLanes(i, rest...));
+}
+
+struct Archetype {
+    uint32_t mask = 0;
+    int count = 0;
+
+    TransformStorage pos;         // TransformComponent
+    TransformStorage prev;        // TransformComponent la inceputul pasului (interpolare)
+    VelocityStorage vel;          // VelocityComponent
+    BoundsStorage bound;          // BoundsComponent
+    Column<float> jiggle;         // JiggleComponent
+    Column<SpriteComponent> sprites;
+    Column<ColliderComponent> colliders;
+    Column<uint32_t> rest;        // RestComponent
+    Column<Entity> entities;      // Handle-ul fiecarui rand
+
+    bool has(uint32_t bits) const { return (mask & bits) == bits; }
+    int capacity() const { return (int)entities.size(); }
+
+    void bindArena(ComponentArena* arena) {
+        pos.bindArena(arena); prev.bindArena(arena);
+        vel.bindArena(arena); bound.bindArena(arena);
+        jiggle.bindArena(arena);
+        sprites.bindArena(arena); colliders.bindArena(arena);
+        rest.bindArena(arena);
+        entities.bindArena(arena);
+    }
+
+    void grow(int capacity) {
+        if (has(COMP_TRANSFORM)) { pos.resize(capacity); prev.resize(capacity); }
+        if (has(COMP_VELOCITY)) vel.resize(capacity);
+        if (has(COMP_BOUNDS)) bound.resize(capacity);
+        if (has(COMP_JIGGLE)) jiggle.resize(capacity);
+        if (has(COMP_SPRITE)) sprites.resize(capacity);
+        if (has(COMP_COLLIDER)) colliders.resize(capacity);
+        if (has(COMP_REST)) rest.resize(capacity);
+        entities.resize(capacity);
+    }
+
+    // Copiaza componentele comune ale randului src din `from` in randul dst
+    void copyRow(int dst, const Archetype& from, int src) {
+        uint32_t common = mask & from.mask;
+        if (common & COMP_TRANSFORM) {
+            pos.x(dst) = from.pos.x(src); pos.y(dst) = from.pos.y(src);
+            prev.x(dst) = from.prev.x(src); prev.y(dst) = from.prev.y(src);
+        }
+        if (common & COMP_VELOCITY) { vel.x(dst) = from.vel.x(src); vel.y(dst) = from.vel.y(src); }
+        if (common & COMP_BOUNDS) { bound.x(dst) = from.bound.x(src); bound.y(dst) = from.bound.y(src); }
+        if (common & COMP_JIGGLE) jiggle[dst] = from.jiggle[src];
+        if (common & COMP_SPRITE) sprites[dst] = from.sprites[src];
+        if (common & COMP_COLLIDER) colliders[dst] = from.colliders[src];
+        if (common & COMP_REST) rest[dst] = from.rest[src];
+        entities[dst] = from.entities[src];
+    }
+};
+
+// Legatura tip -> bit + citire/scriere intr-un rand al tabelului
+template <typename C> struct ComponentTraits;
+
+template <> struct ComponentTraits<TransformComponent> {
+    static const uint32_t bit = COMP_TRANSFORM;
+    static TransformComponent read(const Archetype& a, int row) { return { a.pos.x(row), a.pos.y(row) }; }
+    // Scrierea explicita e un teleport: si pozitia anterioara devine cea noua
+    static void write(Archetype& a, int row, const TransformComponent& v) {
+        a.pos.x(row) = a.prev.x(row) = v.x;
+        a.pos.y(row) = a.prev.y(row) = v.y;
+    }
+};
+
+template <> struct ComponentTraits<VelocityComponent> {
+    static const uint32_t bit = COMP_VELOCITY;
+    static VelocityComponent read(const Archetype& a, int row) { return { a.vel.x(row), a.vel.y(row) }; }
+    static void write(Archetype& a, int row, const VelocityComponent& v) { a.vel.x(row) = v.vx; a.vel.y(row) = v.vy; }
+};
+
+template <> struct ComponentTraits<BoundsComponent> {
+    static const uint32_t bit = COMP_BOUNDS;
+    static BoundsComponent read(const Archetype& a, int row) { return { a.bound.x(row), a.bound.y(row) }; }
+    static void write(Archetype& a, int row, const BoundsComponent& v) { a.bound.x(row) = v.maxX; a.bound.y(row) = v.maxY; }
+};
+
+template <> struct ComponentTraits<JiggleComponent> {
+    static const uint32_t bit = COMP_JIGGLE;
+    static JiggleComponent read(const Archetype& a, int row) { return { a.jiggle[row] }; }
+    static void write(Archetype& a, int row, const JiggleComponent& v) { a.jiggle[row] = v.amplitude; }
+};
+
+template <> struct ComponentTraits<SpriteComponent> {
+    static const uint32_t bit = COMP_SPRITE;
+    static SpriteComponent read(const Archetype& a, int row) { return a.sprites[row]; }
+    static void write(Archetype& a, int row, const SpriteComponent& v) { a.sprites[row] = v; }
+};
+
+template <> struct ComponentTraits<ColliderComponent> {
+    static const uint32_t bit = COMP_COLLIDER;
+    static ColliderComponent read(const Archetype& a, int row) { return a.colliders[row]; }
+    static void write(Archetype& a, int row, const ColliderComponent& v) { a.colliders[row] = v; }
+};
+
+template <> struct ComponentTraits<HiddenComponent> {
+    static const uint32_t bit = COMP_HIDDEN;
+    static HiddenComponent read(const Archetype&, int) { return HiddenComponent(); }
+    static void write(Archetype&, int, const HiddenComponent&) {}
+};
+
+template <> struct ComponentTraits<InactiveComponent> {
+    static const uint32_t bit = COMP_INACTIVE;
+    static InactiveComponent read(const Archetype&, int) { return InactiveComponent(); }
+    static void write(Archetype&, int, const InactiveComponent&) {}
+};
+
+template <> struct ComponentTraits<SteeringComponent> {
+    static const uint32_t bit = COMP_STEERING;
+    static SteeringComponent read(const Archetype&, int) { return SteeringComponent(); }
+    static void write(Archetype&, int, const SteeringComponent&) {}
+};
+
+template <> struct ComponentTraits<RestComponent> {
+    static const uint32_t bit = COMP_REST;
+    static RestComponent read(const Archetype& a, int row) { return { a.rest[row] }; }
+    static void write(Archetype& a, int row, const RestComponent& v) { a.rest[row] = v.quietSteps; }
+};
+
+template <> struct ComponentTraits<SleepingComponent> {
+    static const uint32_t bit = COMP_SLEEPING;
+    static SleepingComponent read(const Archetype&, int) { return SleepingComponent(); }
+    static void write(Archetype&, int, const SleepingComponent&) {}
+};
+
+template <typename... Cs> struct ComponentMask;
+template <> struct ComponentMask<> { static const uint32_t value = 0; };
+template <typename C, typename... Rest> struct ComponentMask<C, Rest...> {
+    static const uint32_t value = ComponentTraits<C>::bit | ComponentMask<Rest...>::value;
+};
+
+class StateFile;
+
+// Rezultatul unui query: lista de arhetipuri din cache-ul Registry-ului, parcursa
+// sarind tabelele goale. Nu aloca; ramane valida pana la urmatorul Registry::init.
+// Un arhetip creat in timpul parcurgerii (add / removeComponent) muta lista: entitatile
+// de schimbat se strang intai, apoi se modifica (ca in setSleep / wakeAll).
+class ArchetypeView {
+private:
+    const std::vector<Archetype*>* tables;
+
+public:
+    class iterator {
+    private:
+        Archetype* const* it;
+        Archetype* const* last;
+        void skipEmpty() { while (it != last && (*it)->count == 0) ++it; }
+
+    public:
+        iterator(Archetype* const* first, Archetype* const* end) : it(first), last(end) { skipEmpty(); }
+        Archetype* operator*() const { return *it; }
+        iterator& operator++() { ++it; skipEmpty(); return *this; }
+        bool operator!=(const iterator& o) const { return it != o.it; }
+    };
+
+    explicit ArchetypeView(const std::vector<Archetype*>& list) : tables(&list) {}
+
+    iterator begin() const { return iterator(tables->data(), tables->data() + tables->size()); }
+    iterator end() const { return iterator(tables->data() + tables->size(), tables->data() + tables->size()); }
+    bool empty() const { return !(begin() != end()); }
+
+    // Tabelele ne-goale in `out` (capacitatea lui se refoloseste de la un pas la altul)
+    void copyTo(std::vector<Archetype*>& out) const {
+        out.clear();
+        for (Archetype* a : *this) out.push_back(a);
+    }
+};
+
+class Registry {
+private:
+    friend class StateFile; // Salveaza / incarca tabelele direct
+    ComponentArena arena;   // Inainte de archetypes: coloanele se distrug primele
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<uint32_t> generations;   // Pe slot: generatia curenta
+    std::vector<int> slotArchetype;      // Pe slot: indexul arhetipului
+    std::vector<int> slotRow;            // Pe slot: randul in arhetip
+    std::vector<uint32_t> freeSlots;     // Slot-uri refolosibile (LIFO)
+    int initialCapacity = 64;
+
+    // Cache de query-uri: pentru fiecare (masca, exclus) cerut, arhetipurile potrivite in
+    // ordinea crearii (si cele goale, sarite de ArchetypeView). Un arhetip nou se adauga
+    // in intrarile care i se potrivesc. Arhetipurile apar doar in etape structurale, care
+    // ruleaza singure, deci listele nu se schimba cat timp alt thread le parcurge;
+    // mutex-ul pazeste doar lista de intrari (view() se cheama si din etape paralele).
+    struct ViewCacheEntry {
+        uint32_t mask, exclude;
+        std::vector<Archetype*> tables;
+    };
+    mutable std::mutex viewMutex;
+    mutable std::vector<std::unique_ptr<ViewCacheEntry>> viewCache;
+
+    static bool matches(const Archetype& a, uint32_t mask, uint32_t exclude) {
+        return a.has(mask) && (a.mask & exclude) == 0;
+    }
+
+    static uint32_t slotOf(Entity e) { return e & ENTITY_INDEX_MASK; }
+    static uint32_t generationOf(Entity e) { return e >> ENTITY_INDEX_BITS; }
+
+    int findOrCreateArchetype(uint32_t mask) {
+        for (size_t i = 0; i < archetypes.size(); i++) {
+            if (archetypes[i]->mask == mask) return (int)i;
+        }
+        std::unique_ptr<Archetype> a(new Archetype());
+        a->mask = mask;
+        a->bindArena(&arena);
+        a->grow(initialCapacity);
+        {
+            std::lock_guard<std::mutex> lk(viewMutex);
+            for (const auto& c : viewCache) {
+                if (matches(*a, c->mask, c->exclude)) c->tables.push_back(a.get());
+            }
+        }
+        archetypes.push_back(std::move(a));
+        return (int)archetypes.size() - 1;
+    }
+
+    int pushRow(int archIndex) {
+        Archetype& a = *archetypes[archIndex];
+        if (a.count >= a.capacity()) a.grow(std::max(64, a.capacity() * 2));
+        return a.count++;
+    }
+
+    // Swap-and-pop: ultimul rand ia locul celui eliberat
+    void removeRow(int archIndex, int row) {
+        Archetype& a = *archetypes[archIndex];
+        int last = a.count - 1;
+        if (row != last) {
+            a.copyRow(row, a, last);
+            slotRow[slotOf(a.entities[row])] = row;
+        }
+        a.count--;
+    }
+
+    // Muta entitatea intr-un alt arhetip; componentele noi raman neinitializate
+    void changeArchetype(Entity e, uint32_t newMask) {
+        uint32_t slot = slotOf(e);
+        int oldArch = slotArchetype[slot];
+        int oldRow = slotRow[slot];
+        if (archetypes[oldArch]->mask == newMask) return;
+
+        int newArch = findOrCreateArchetype(newMask);
+        int newRow = pushRow(newArch);
+        archetypes[newArch]->copyRow(newRow, *archetypes[oldArch], oldRow);
+        removeRow(oldArch, oldRow);
+
+        slotArchetype[slot] = newArch;
+        slotRow[slot] = newRow;
+    }
+
+public:
+    // Capacitatea initiala a fiecarui arhetip; tabelele cresc la nevoie
+    // Fara arena (rezervare esuata) coloanele raman pe heap aliniat
+    void init(int maxEntities, const ArenaConfig& arenaConfig = ArenaConfig()) {
+        {
+            std::lock_guard<std::mutex> lk(viewMutex);
+            viewCache.clear();
+        }
+        archetypes.clear();
+        generations.clear();
+        slotArchetype.clear();
+        slotRow.clear();
+        freeSlots.clear();
+        initialCapacity = std::max(64, maxEntities);
+        arena.init(arenaConfig);
+    }
+
+    const ComponentArena& componentArena() const { return arena; }
+
+    template <typename... Cs>
+    Entity createEntity() {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            if (generations.size() >= ENTITY_INDEX_MASK) return INVALID_ENTITY; // Slot-ul 0xFFFFFF ramane nefolosit
+            slot = (uint32_t)generations.size();
+            generations.push_back(0);
+            slotArchetype.push_back(-1);
+            slotRow.push_back(-1);
+        }
+
+        int arch = findOrCreateArchetype(ComponentMask<Cs...>::value);
+        int row = pushRow(arch);
+        Entity e = (generations[slot] << ENTITY_INDEX_BITS) | slot;
+        archetypes[arch]->entities[row] = e;
+        slotArchetype[slot] = arch;
+        slotRow[slot] = row;
+        return e;
+    }
+
+    bool isAlive(Entity e) const {
+        uint32_t slot = slotOf(e);
+        return e != INVALID_ENTITY && slot < generations.size() && generations[slot] == generationOf(e) &&
+            slotArchetype[slot] >= 0; // Slot retras: generatia 0xFF, fara arhetip
+    }
+
+    // Tabelul si randul entitatii; null / -1 pentru handle invalid sau vechi
+    Archetype* locate(Entity e, int& row) const {
+        if (!isAlive(e)) {
+            row = -1;
+            return nullptr;
+        }
+        row = slotRow[slotOf(e)];
+        return archetypes[slotArchetype[slotOf(e)]].get();
+    }
+
+    template <typename C>
+    bool has(Entity e) const {
+        int row;
+        Archetype* a = locate(e, row);
+        return a && a->has(ComponentTraits<C>::bit);
+    }
+
+    // Entitatea trebuie sa fie vie si sa aiba C (assert in debug); altfel, in release,
+    // get intoarce C{} si set nu face nimic
+    template <typename C>
+    C get(Entity e) const {
+        int row;
+        Archetype* a = locate(e, row);
+        assert(a && a->has(ComponentTraits<C>::bit));
+        if (!a || !a->has(ComponentTraits<C>::bit)) return C();
+        return ComponentTraits<C>::read(*a, row);
+    }
+
+    template <typename C>
+    void set(Entity e, const C& value) {
+        int row;
+        Archetype* a = locate(e, row);
+        assert(a && a->has(ComponentTraits<C>::bit));
+        if (!a || !a->has(ComponentTraits<C>::bit)) return;
+        ComponentTraits<C>::write(*a, row, value);
+    }
+
+    // Handle vechi: nu face nimic
+    template <typename C>
+    void addComponent(Entity e, const C& value) {
+        int row;
+        Archetype* a = locate(e, row);
+        if (!a) return;
+        changeArchetype(e, a->mask | ComponentTraits<C>::bit);
+        set(e, value);
+    }
+
+    template <typename C>
+    void removeComponent(Entity e) {
+        int row;
+        Archetype* a = locate(e, row);
+        if (!a) return;
+        changeArchetype(e, a->mask & ~ComponentTraits<C>::bit);
+    }
+
+    // Intoarce false pt handle vechi
+    bool destroyEntity(Entity e) {
+        if (!isAlive(e)) return false;
+
+        uint32_t slot = slotOf(e);
+        removeRow(slotArchetype[slot], slotRow[slot]);
+        generations[slot]++;
+        slotArchetype[slot] = -1;
+        slotRow[slot] = -1;
+        // Generatia saturata: slot-ul e retras, handle-urile vechi raman invalide
+        if (generations[slot] < ENTITY_GENERATION_MASK) freeSlots.push_back(slot);
+        return true;
+    }
+
+    int entityCount() const {
+        int n = 0;
+        for (const auto& a : archetypes) n += a->count;
+        return n;
+    }
+
+    // Query tipizat: tabelele (ne-goale) care au cel putin componentele cerute si niciun
+    // bit din `exclude` (ex. COMP_INACTIVE), in ordinea crearii (stabila de la un frame
+    // la altul). Lista vine din cache, fara alocare.
+    template <typename... Cs>
+    ArchetypeView view(uint32_t exclude = 0) const {
+        return viewMask(ComponentMask<Cs...>::value, exclude);
+    }
+
+    // Acelasi query, cu masca data la rulare (SystemScheduler)
+    ArchetypeView viewMask(uint32_t mask, uint32_t exclude = 0) const {
+        std::lock_guard<std::mutex> lk(viewMutex);
+        for (const auto& c : viewCache) {
+            if (c->mask == mask && c->exclude == exclude) return ArchetypeView(c->tables);
+        }
+        std::unique_ptr<ViewCacheEntry> c(new ViewCacheEntry());
+        c->mask = mask;
+        c->exclude = exclude;
+        for (const auto& a : archetypes) {
+            if (matches(*a, mask, exclude)) c->tables.push_back(a.get());
+        }
+        viewCache.push_back(std::move(c));
+        return ArchetypeView(viewCache.back()->tables);
+    }
+};
+
+// ==========================================
+// 3. JOB SYSTEM (thread pool persistent)
+// ==========================================
+// Workerii sunt creati o singura data si dorm pe un condition_variable cand nu au
+// de lucru. Fiecare thread are un deque propriu: proprietarul imparte intervalul
+// in doua, pune jumatatea din dreapta in coada si continua cu stanga (LIFO, cache
+// cald), iar thread-urile libere fura din capul cozilor celorlalti (FIFO, bucati mari).
+// Thread-ul care apeleaza parallelFor lucreaza si el pana se termina intervalul.
+//
+// Thread-urile externe (main = coada 0, plus cele legate cu attachExternal, ex. thread-ul
+// de simulare) au fiecare coada lor, iar cat asteapta ajuta doar la bucatile job-ului
+// propriu: render-ul de pe main nu ruleaza bucati din simulare si invers, deci timpul
+// unui frame nu depinde de pasul de simulare care merge in paralel. Workerii iau orice.
+class JobSystem {
+private:
+    typedef void (*RangeFn)(void* ctx, int start, int end);
+
+    struct RangeJob {
+        RangeFn fn;
+        void* ctx;
+        int grain;
+        int align;   // Granitele bucatilor sunt multipli de align
+        std::atomic<int> remaining; // Elemente inca neprocesate
+    };
+
+    struct Task {
+        RangeJob* job;
+        int start, end;
+    };
+
+    struct WorkQueue {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        std::vector<Task> ring;
+        unsigned int head = 0; // Capul (furt)
+        unsigned int tail = 0; // Coada (proprietar)
+        char pad[64];          // Fara false sharing intre cozi
+
+        void acquire() { while (lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield(); }
+        void release() { lock.clear(std::memory_order_release); }
+
+        bool push(const Task& t) {
+            acquire();
+            bool ok = tail - head < ring.size();
+            if (ok) ring[tail++ % ring.size()] = t;
+            release();
+            return ok;
+        }
+
+        // `only` != null: doar daca task-ul de la capat e din job-ul asta
+        bool pop(Task& t, const RangeJob* only) {
+            acquire();
+            bool ok = tail != head && (!only || ring[(tail - 1) % ring.size()].job == only);
+            if (ok) t = ring[--tail % ring.size()];
+            release();
+            return ok;
+        }
+
+        bool steal(Task& t, const RangeJob* only) {
+            acquire();
+            bool ok = tail != head && (!only || ring[head % ring.size()].job == only);
+            if (ok) t = ring[head++ % ring.size()];
+            release();
+            return ok;
+        }
+    };
+
+    static const int QUEUE_CAPACITY = 1024;
+    static const int SPIN_COUNT = 64;
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<WorkQueue[]> queues; // [0, externalQueues) = thread-urile externe, apoi workerii
+    int numQueues = 0;
+    int externalQueues = 1;
+    int numThreads = 1;                  // Workerii + un thread extern
+
+    std::atomic<int> queuedTasks{ 0 };
+    std::atomic<int> sleepingWorkers{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+
+    // Coada thread-ului curent in JobSystem-ul `queueOwner`; in alt JobSystem e 0
+    static thread_local const JobSystem* queueOwner;
+    static thread_local int workerIndex;
+
+    int queueIndex() const { return queueOwner == this ? workerIndex : 0; }
+
+    template <typename Fn>
+    static void invokeRange(void* ctx, int start, int end) {
+        (*static_cast<Fn*>(ctx))(start, end);
+    }
+
+    void wakeWorkers() {
+        if (sleepingWorkers.load() > 0) {
+            { std::lock_guard<std::mutex> lk(sleepMutex); }
+            sleepCv.notify_all();
+        }
+    }
+
+    bool findTask(Task& t, const RangeJob* only) {
+        int self = queueIndex();
+        bool found = queues[self].pop(t, only);
+        for (int k = 1; !found && k < numQueues; k++) {
+            found = queues[(self + k) % numQueues].steal(t, only);
+        }
+        if (found) queuedTasks.fetch_sub(1);
+        return found;
+    }
+
+    void execute(Task t) {
+        RangeJob* job = t.job;
+        // Impartire binara: jumatatea dreapta ramane de furat
+        while (t.end - t.start > job->grain) {
+            int mid = t.start + (t.end - t.start) / 2;
+            mid -= mid % job->align;
+            if (mid <= t.start) break;
+            Task right = { job, mid, t.end };
+            queuedTasks.fetch_add(1);
+            if (!queues[queueIndex()].push(right)) {
+                queuedTasks.fetch_sub(1);
+                break; // Coada plina: facem tot intervalul aici
+            }
+            wakeWorkers();
+            t.end = mid;
+        }
+        job->fn(job->ctx, t.start, t.end);
+        job->remaining.fetch_sub(t.end - t.start, std::memory_order_acq_rel);
+    }
+
+    void workerLoop(int index) {
+        queueOwner = this;
+        workerIndex = index;
+        while (true) {
+            Task t;
+            if (findTask(t, nullptr)) {
+                execute(t);
+                continue;
+            }
+
+            bool hasWork = false;
+            for (int spin = 0; spin < SPIN_COUNT && !hasWork; spin++) {
+                hasWork = queuedTasks.load() > 0 || stopping.load();
+                if (!hasWork) std::this_thread::yield();
+            }
+            if (stopping.load()) return;
+            if (hasWork) continue;
+
+            std::unique_lock<std::mutex> lk(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            sleepCv.wait(lk, [this] { return stopping.load() || queuedTasks.load() > 0; });
+            sleepingWorkers.fetch_sub(1);
+            if (stopping.load()) return;
+        }
+    }
+
+public:
+    // `threads` = workerii + thread-ul care apeleaza (main); `externalThreads` = cate
+    // thread-uri externe primesc coada lor (main + cele legate cu attachExternal)
+    explicit JobSystem(unsigned int threads = 0, int externalThreads = 1) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 2;
+
+        numThreads = (int)threads;
+        externalQueues = std::max(1, externalThreads);
+        numQueues = externalQueues + numThreads - 1;
+        queues.reset(new WorkQueue[numQueues]);
+        for (int i = 0; i < numQueues; i++) queues[i].ring.resize(QUEUE_CAPACITY);
+
+        // Thread-ul principal e al N-lea "worker"
+        for (int i = externalQueues; i < numQueues; i++) workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lk(sleepMutex);
+            stopping.store(true);
+        }
+        sleepCv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int threadCount() const { return numThreads; }
+
+    // Thread-ul curent foloseste coada externa `slot` (1 .. externalThreads - 1)
+    void attachExternal(int slot) {
+        queueOwner = this;
+        workerIndex = std::min(std::max(slot, 0), externalQueues - 1);
+    }
+
+    // Ruleaza fn(start, end) pe bucati de cel mult `grain` elemente din [begin, end)
+    // si se intoarce doar dupa ce tot intervalul a fost procesat.
+    template <typename Fn>
+    void parallelFor(int begin, int end, int grain, Fn&& fn) {
+        parallelFor(begin, end, grain, 1, std::forward<Fn>(fn));
+    }
+
+    // La fel, dar fiecare granita interioara e multiplu de `align` (ex. randurile dintr-o
+    // linie de cache): doua thread-uri nu scriu niciodata in aceeasi linie
+    template <typename Fn>
+    void parallelFor(int begin, int end, int grain, int align, Fn&& fn) {
+        if (end <= begin) return;
+        if (grain < 1) grain = 1;
+        if (align < 1) align = 1;
+        if (end - begin <= grain || workers.empty()) {
+            fn(begin, end);
+            return;
+        }
+
+        typedef typename std::remove_reference<Fn>::type FnType;
+        RangeJob job;
+        job.fn = &invokeRange<FnType>;
+        job.ctx = (void*)&fn;
+        job.grain = grain;
+        job.align = align;
+        job.remaining.store(end - begin);
+
+        execute({ &job, begin, end });
+
+        // Ajutam pana cand toate bucatile (inclusiv cele furate) sunt gata; un thread
+        // extern doar cu bucatile job-ului asta
+        const RangeJob* only = queueIndex() < externalQueues ? &job : nullptr;
+        while (job.remaining.load(std::memory_order_acquire) > 0) {
+            Task t;
+            if (findTask(t, only)) execute(t);
+            else std::this_thread::yield();
+        }
+    }
+};
+
+thread_local const JobSystem* JobSystem::queueOwner = nullptr;
+thread_local int JobSystem::workerIndex = 0;
+
+// --- TRIPLE BUFFER ---
+// Un producator (simularea) si un consumator (render) schimba buffere fara lock-uri:
+// producatorul scrie mereu in `back`, consumatorul citeste mereu din `front`, iar
+// `middle` (index + bit FRESH) e singurul schimbat atomic. Niciunul nu asteapta dupa
+// celalalt; consumatorul vede mereu cel mai nou buffer publicat.
+template <typename T>
+class TripleBuffer {
+private:
+    static const int FRESH = 4;
+
+    T buffers[3];
+    std::atomic<int> middle{ 1 };
+    int back = 0;  // Doar producatorul
+    int front = 2; // Doar consumatorul
+
+public:
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3;
+    }
+
+    // true daca s-a publicat ceva nou de la ultimul apel
+    bool acquireLatest() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[front]; }
+};
+
+// ==========================================
+// 4. PROFILER
+// ==========================================
+// PROFILE_ZONE("Nume") cronometreaza blocul curent. Fiecare thread scrie evenimentele
+// in propriul ring buffer (un singur producator, fara lock-uri); main le citeste o
+// data pe frame in endFrame(). Cand ring-ul e plin producatorul arunca evenimentul nou
+// (numarat in droppedEvents), nu suprascrie sloturi pe care endFrame le poate citi.
+// In endFrame:
+//  - aduna timpul fiecarei zone pe frame (suma pe toate thread-urile / bucatile)
+//    intr-un istoric de HISTORY frame-uri -> min / avg / p99 pentru overlay
+//  - daca o captura e activa, pastreaza evenimentele pt export Chrome trace
+//    (chrome://tracing sau ui.perfetto.dev)
+// Numele zonelor trebuie sa fie literali (se pastreaza doar pointerul).
+// Compilat cu -DPROFILER_ENABLED=0, PROFILE_ZONE dispare complet.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+struct ProfileEvent {
+    const char* name;
+    Uint64 start, end; // SDL_GetPerformanceCounter
+};
+
+class Profiler {
+public:
+    static const int RING_CAPACITY = 1 << 14; // Evenimente per thread intre doua endFrame
+    static const int HISTORY = 240;           // Frame-uri pentru min / avg / p99
+
+    struct ZoneStats {
+        const char* name;
+        float history[HISTORY]; // ms pe frame
+        int filled = 0;
+        int next = 0;
+        float frameTotal = 0.0f;
+        bool seen = false;      // A aparut in frame-ul curent
+        float minMs = 0, avgMs = 0, p99Ms = 0;
+    };
+
+private:
+    struct ThreadRing {
+        ProfileEvent events[RING_CAPACITY];
+        std::atomic<uint64_t> written{ 0 }; // Scris doar de proprietar
+        std::atomic<uint64_t> read{ 0 };    // Scris doar de endFrame, citit de proprietar
+        std::atomic<uint64_t> dropped{ 0 }; // Scris doar de proprietar (ring plin)
+        int tid = 0;
+        std::string name;
+    };
+
+    struct CapturedEvent {
+        ProfileEvent event;
+        int tid;
+    };
+
+    std::mutex ringsMutex; // Doar la inregistrarea unui thread nou si in endFrame
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::vector<ZoneStats> zones;
+    std::vector<float> sortScratch;
+
+    std::vector<CapturedEvent> captured;
+    int captureFramesLeft = 0;
+    std::string capturePath;
+    Uint64 captureOrigin = 0;
+
+    static thread_local ThreadRing* localRing;
+
+    ThreadRing& ring() {
+        if (!localRing) {
+            std::unique_ptr<ThreadRing> r(new ThreadRing());
+            std::lock_guard<std::mutex> lk(ringsMutex);
+            r->tid = (int)rings.size();
+            r->name = "thread " + std::to_string(r->tid);
+            localRing = r.get();
+            rings.push_back(std::move(r));
+        }
+        return *localRing;
+    }
+
+    ZoneStats& zone(const char* name) {
+        for (ZoneStats& z : zones) {
+            if (z.name == name || strcmp(z.name, name) == 0) return z;
+        }
+        zones.emplace_back();
+        zones.back().name = name;
+        return zones.back();
+    }
+
+    void updateStats(ZoneStats& z) {
+        z.history[z.next] = z.frameTotal;
+        z.next = (z.next + 1) % HISTORY;
+        if (z.filled < HISTORY) z.filled++;
+
+        sortScratch.assign(z.history, z.history + z.filled);
+        float sum = 0.0f;
+        for (float v : sortScratch) sum += v;
+        size_t p99 = (sortScratch.size() * 99) / 100;
+        std::nth_element(sortScratch.begin(), sortScratch.begin() + p99, sortScratch.end());
+        z.p99Ms = sortScratch[p99];
+        z.minMs = *std::min_element(sortScratch.begin(), sortScratch.end());
+        z.avgMs = sum / z.filled;
+    }
+
+    void writeTrace() {
+        std::ofstream out(capturePath);
+        double toUs = 1e6 / (double)SDL_GetPerformanceFrequency();
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        {
+            std::lock_guard<std::mutex> lk(ringsMutex);
+            for (const auto& r : rings) {
+                out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+                    << ",\"args\":{\"name\":\"" << r->name << "\"}}";
+                first = false;
+            }
+        }
+        for (const CapturedEvent& c : captured) {
+            out << (first ? "" : ",\n") << "{\"name\":\"" << c.event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << c.tid
+                << ",\"ts\":" << (double)(c.event.start - captureOrigin) * toUs
+                << ",\"dur\":" << (double)(c.event.end - c.event.start) * toUs << "}";
+            first = false;
+        }
+        out << "\n]}\n";
+        std::cout << "Trace: " << capturePath << " (" << captured.size() << " evenimente)" << std::endl;
+        captured.clear();
+    }
+
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // Numele thread-ului curent in trace (implicit "thread N")
+    void setThreadName(const char* name) {
+        ThreadRing& r = ring();
+        std::lock_guard<std::mutex> lk(ringsMutex);
+        r.name = name;
+    }
+
+    void record(const char* name, Uint64 start, Uint64 end) {
+        ThreadRing& r = ring();
+        uint64_t w = r.written.load(std::memory_order_relaxed);
+        // Slotul e liber doar dupa ce endFrame a terminat de citit evenimentul vechi
+        if (w - r.read.load(std::memory_order_acquire) >= RING_CAPACITY) {
+            r.dropped.store(r.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        r.events[w % RING_CAPACITY] = { name, start, end };
+        r.written.store(w + 1, std::memory_order_release);
+    }
+
+    // Urmatoarele `frames` frame-uri se salveaza in `path` ca Chrome trace JSON
+    void beginCapture(int frames, const std::string& path) {
+        captured.clear();
+        captureFramesLeft = frames;
+        capturePath = path;
+        captureOrigin = SDL_GetPerformanceCounter();
+    }
+
+    bool isCapturing() const { return captureFramesLeft > 0; }
+
+    // Apelat de main la sfarsitul fiecarui frame, cand workerii nu mai lucreaza
+    void endFrame() {
+        double toMs = 1000.0 / (double)SDL_GetPerformanceFrequency();
+        for (ZoneStats& z : zones) {
+            z.frameTotal = 0.0f;
+            z.seen = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(ringsMutex);
+            for (const auto& r : rings) {
+                uint64_t written = r->written.load(std::memory_order_acquire);
+                uint64_t read = r->read.load(std::memory_order_relaxed);
+                for (; read < written; read++) {
+                    const ProfileEvent& e = r->events[read % RING_CAPACITY];
+                    ZoneStats& z = zone(e.name);
+                    z.frameTotal += (float)((e.end - e.start) * toMs);
+                    z.seen = true;
+                    if (captureFramesLeft > 0) captured.push_back({ e, r->tid });
+                }
+                // Abia acum producatorul poate refolosi sloturile citite
+                r->read.store(read, std::memory_order_release);
+            }
+        }
+
+        for (ZoneStats& z : zones) {
+            if (z.seen) updateStats(z);
+        }
+
+        if (captureFramesLeft > 0 && --captureFramesLeft == 0) writeTrace();
+    }
+
+    const std::vector<ZoneStats>& stats() const { return zones; }
+
+    // Evenimente aruncate pentru ca un ring era plin (endFrame prea rar)
+    uint64_t droppedEvents() {
+        std::lock_guard<std::mutex> lk(ringsMutex);
+        uint64_t total = 0;
+        for (const auto& r : rings) total += r->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    float averageMs(const char* name) const {
+        for (const ZoneStats& z : zones) {
+            if (strcmp(z.name, name) == 0) return z.avgMs;
+        }
+        return 0.0f;
+    }
+};
+
+thread_local Profiler::ThreadRing* Profiler::localRing = nullptr;
+
+class ProfileScope {
+private:
+    const char* name;
+    Uint64 start;
+
+public:
+    explicit ProfileScope(const char* zoneName) : name(zoneName), start(SDL_GetPerformanceCounter()) {}
+    ~ProfileScope() { Profiler::instance().record(name, start, SDL_GetPerformanceCounter()); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+// --- CONTOARE HARDWARE (perf_event_open, --headless --perf) ---
+// Cicluri, instructiuni, miss-uri L1d / LLC / dTLB si branch-uri gresite, numarate doar
+// in user space. O etapa a schedulerului lucreaza pe toate thread-urile (parallelFor),
+// deci contoarele se deschid pe fiecare thread existent al procesului (/proc/self/task:
+// main / sim + workerii JobSystem) si o citire e suma lor. Thread-urile pornite dupa
+// open() nu sunt numarate.
+// Fiecare contor e deschis separat, nu in grup: daca PMU-ul are mai putine registre,
+// kernelul le multiplexeaza si valorile se scaleaza cu timpul in care au numarat.
+// Un eveniment care nu se deschide pe toate thread-urile (alt OS, VM fara PMU,
+// perf_event_paranoid) ramane indisponibil si apare ca "-".
+enum PerfEvent {
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+const char* perfEventName(int e) {
+    static const char* const names[PERF_EVENT_COUNT] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses" };
+    return names[e];
+}
+
+// Valori cumulate (sau diferente / sume de valori cumulate), cate una per eveniment
+struct PerfSample {
+    double value[PERF_EVENT_COUNT] = {};
+};
+
+class PerfCounters {
+private:
+    std::vector<int> fds;   // Thread-ul t, evenimentul e: fds[t * PERF_EVENT_COUNT + e]
+    bool opened[PERF_EVENT_COUNT] = {};
+    int threads = 0;
+    std::string error;      // Primul eveniment care n-a mers si de ce
+
+#if PERF_COUNTERS
+    static void eventConfig(int e, perf_event_attr& attr) {
+        const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+        case PERF_CYCLES: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PERF_INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PERF_LLC_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break; // Pe x86 = LLC
+        case PERF_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PERF_L1D_MISSES: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss; break;
+        default: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss; break;
+        }
+    }
+
+    static std::vector<int> threadIds() {
+        std::vector<int> tids;
+        if (DIR* dir = opendir("/proc/self/task")) {
+            while (dirent* d = readdir(dir)) {
+                int tid = atoi(d->d_name);
+                if (tid > 0) tids.push_back(tid);
+            }
+            closedir(dir);
+        }
+        std::sort(tids.begin(), tids.end());
+        return tids;
+    }
+#endif
+
+public:
+    PerfCounters() {}
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // true daca macar un eveniment numara pe toate thread-urile
+    bool open() {
+        close();
+#if PERF_COUNTERS
+        std::vector<int> tids = threadIds();
+        threads = (int)tids.size();
+        fds.assign(tids.size() * PERF_EVENT_COUNT, -1);
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            eventConfig(e, attr);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            opened[e] = threads > 0;
+            for (int t = 0; t < threads && opened[e]; t++) {
+                int fd = (int)syscall(SYS_perf_event_open, &attr, tids[t], -1, -1, PERF_FLAG_FD_CLOEXEC);
+                fds[t * PERF_EVENT_COUNT + e] = fd;
+                if (fd < 0) {
+                    if (error.empty()) error = std::string(perfEventName(e)) + ": " + strerror(errno);
+                    opened[e] = false;
+                }
+            }
+            // Numarat doar pe o parte din thread-uri ar fi inselator: eveniment indisponibil
+            if (!opened[e]) {
+                for (int t = 0; t < threads; t++) {
+                    int& fd = fds[t * PERF_EVENT_COUNT + e];
+                    if (fd >= 0) ::close(fd);
+                    fd = -1;
+                }
+            }
+        }
+        if (!any()) {
+            std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+            int level = 0;
+            if (paranoid >> level) error += " (perf_event_paranoid = " + std::to_string(level) + ")";
+        }
+#else
+        error = "perf_event_open exista doar pe Linux";
+#endif
+        return any();
+    }
+
+    void close() {
+#if PERF_COUNTERS
+        for (int fd : fds) {
+            if (fd >= 0) ::close(fd);
+        }
+#endif
+        fds.clear();
+        std::fill(opened, opened + PERF_EVENT_COUNT, false);
+        threads = 0;
+        error.clear();
+    }
+
+    bool available(int e) const { return opened[e]; }
+    bool any() const { return std::find(opened, opened + PERF_EVENT_COUNT, true) != opened + PERF_EVENT_COUNT; }
+    int threadCount() const { return threads; }
+    const std::string& lastError() const { return error; }
+
+    // Suma pe thread-uri a valorilor cumulate de la open(), scalate daca au fost multiplexate
+    void read(PerfSample& out) const {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            out.value[e] = 0.0;
+#if PERF_COUNTERS
+            if (!opened[e]) continue;
+            for (int t = 0; t < threads; t++) {
+                uint64_t raw[3]; // valoare, timp activat, timp numarat
+                if (::read(fds[t * PERF_EVENT_COUNT + e], raw, sizeof(raw)) != (ssize_t)sizeof(raw) || raw[2] == 0) continue;
+                out.value[e] += (double)raw[0] * ((double)raw[1] / (double)raw[2]);
+            }
+#endif
+        }
+    }
+};
+
+// total += end - begin
+void accumulatePerf(PerfSample& total, const PerfSample& begin, const PerfSample& end) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) total.value[e] += end.value[e] - begin.value[e];
+}
+
+double perfIPC(const PerfSample& s) {
+    return s.value[PERF_CYCLES] > 0.0 ? s.value[PERF_INSTRUCTIONS] / s.value[PERF_CYCLES] : 0.0;
+}
+
+// "IPC 1.85 | cycles 4.1 | instructions 7.6 | ..." cu fiecare eveniment impartit la
+// `entities` ("-" = contor indisponibil)
+std::string formatPerf(const PerfCounters& counters, const PerfSample& s, double entities) {
+    std::string out = "IPC ";
+    out += counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS) ? std::to_string(perfIPC(s)) : "-";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        out += std::string(" | ") + perfEventName(e) + " ";
+        out += counters.available(e) && entities > 0.0 ? std::to_string(s.value[e] / entities) : "-";
+    }
+    return out;
+}
+
+// ==========================================
+// 5. KERNELE DE INTEGRARE (SIMD)
+// ==========================================
+// Trei kernel-e, fiecare pe un interval [start, end):
+//  - move:   miscare + bounce pentru entitatile cu Velocity + Bounds; bounce-ul e o
+//            inversare de semn mascata, fara branch-uri
+//  - jiggle: tremuratul entitatilor cu Jiggle (monedele), din RNG-ul counter-based
+//  - steer:  viteza noua a agentilor din stol, din sumele de vecini (SteeringSystem)
+// Toate variantele fac exact aceleasi operatii float in aceeasi ordine (fara FMA, vezi
+// inceputul fisierului), deci dau rezultate identice bit cu bit cu varianta scalara.
+struct MoveParams {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    const float* boundX;
+    const float* boundY;
+    float dt;
+    int start, end;
+};
+
+struct JiggleParams {
+    float* x;
+    float* y;
+    const float* amplitude;
+    const uint32_t* ids; // Handle-ul entitatii: jiggle-ul o urmeaza si dupa compactare
+    uint32_t key;        // frameKey() pentru frame-ul curent
+    int start, end;
+};
+
+typedef void (*MoveKernel)(const MoveParams& p);
+typedef void (*JiggleKernel)(const JiggleParams& p);
+
+void moveScalar(const MoveParams& p) {
+    for (int i = p.start; i < p.end; i++) {
+        // Move
+        p.x[i] += p.vx[i] * p.dt;
+        p.y[i] += p.vy[i] * p.dt;
+
+        // Bounce (Pereti)
+        if (p.x[i] <= 0 || p.x[i] >= p.boundX[i]) p.vx[i] *= -1;
+        if (p.y[i] <= 0 || p.y[i] >= p.boundY[i]) p.vy[i] *= -1;
+    }
+}
+
+void jiggleScalar(const JiggleParams& p) {
+    for (int i = p.start; i < p.end; i++) {
+        // Jiggle (Tremurat)
+        p.x[i] += p.amplitude[i] * counterRandom(p.key, 2 * p.ids[i], -1.0f, 1.0f);
+        p.y[i] += p.amplitude[i] * counterRandom(p.key, 2 * p.ids[i] + 1, -1.0f, 1.0f);
+    }
+}
+
+#if defined(SIMD_X86)
+// --- SSE2 (4 benzi) ---
+inline __m128i mullo32SSE2(__m128i a, __m128i b) {
+    // SSE2 nu are _mm_mullo_epi32: inmultim benzile pare si impare separat
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128 randomSignedSSE2(__m128i h) {
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    h = mullo32SSE2(h, _mm_set1_epi32(0x7feb352d));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo32SSE2(h, _mm_set1_epi32((int)0x846ca68bU));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+    return _mm_add_ps(_mm_set1_ps(-1.0f), _mm_mul_ps(unit, _mm_set1_ps(2.0f)));
+}
+
+void moveSSE2(const MoveParams& p) {
+    const __m128 dt = _mm_set1_ps(p.dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    int i = p.start;
+    for (; i + 4 <= p.end; i += 4) {
+        __m128 vx = _mm_loadu_ps(p.vx + i);
+        __m128 vy = _mm_loadu_ps(p.vy + i);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(p.x + i), _mm_mul_ps(vx, dt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(p.y + i), _mm_mul_ps(vy, dt));
+
+        __m128 hitX = _mm_or_ps(_mm_cmple_ps(x, zero), _mm_cmpge_ps(x, _mm_loadu_ps(p.boundX + i)));
+        __m128 hitY = _mm_or_ps(_mm_cmple_ps(y, zero), _mm_cmpge_ps(y, _mm_loadu_ps(p.boundY + i)));
+
+        _mm_storeu_ps(p.x + i, x);
+        _mm_storeu_ps(p.y + i, y);
+        _mm_storeu_ps(p.vx + i, _mm_xor_ps(vx, _mm_and_ps(hitX, sign)));
+        _mm_storeu_ps(p.vy + i, _mm_xor_ps(vy, _mm_and_ps(hitY, sign)));
+    }
+
+    MoveParams tail = p;
+    tail.start = i;
+    moveScalar(tail);
+}
+
+void jiggleSSE2(const JiggleParams& p) {
+    const __m128i key = _mm_set1_epi32((int)p.key);
+    const __m128i one = _mm_set1_epi32(1);
+
+    int i = p.start;
+    for (; i + 4 <= p.end; i += 4) {
+        __m128i counters = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)(p.ids + i)), 1);
+        __m128 amp = _mm_loadu_ps(p.amplitude + i);
+        __m128 rx = randomSignedSSE2(_mm_xor_si128(key, counters));
+        __m128 ry = randomSignedSSE2(_mm_xor_si128(key, _mm_add_epi32(counters, one)));
+
+        _mm_storeu_ps(p.x + i, _mm_add_ps(_mm_loadu_ps(p.x + i), _mm_mul_ps(amp, rx)));
+        _mm_storeu_ps(p.y + i, _mm_add_ps(_mm_loadu_ps(p.y + i), _mm_mul_ps(amp, ry)));
+    }
+
+    JiggleParams tail = p;
+    tail.start = i;
+    jiggleScalar(tail);
+}
+
+// --- AVX2 (8 benzi) ---
+TARGET_AVX2 inline __m256 randomSignedAVX2(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7feb352d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)0x846ca68bU));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    __m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+    return _mm256_add_ps(_mm256_set1_ps(-1.0f), _mm256_mul_ps(unit, _mm256_set1_ps(2.0f)));
+}
+
+TARGET_AVX2 void moveAVX2(const MoveParams& p) {
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    int i = p.start;
+    for (; i + 8 <= p.end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(p.vx + i);
+        __m256 vy = _mm256_loadu_ps(p.vy + i);
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(p.x + i), _mm256_mul_ps(vx, dt));
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(p.y + i), _mm256_mul_ps(vy, dt));
+
+        __m256 hitX = _mm256_or_ps(_mm256_cmp_ps(x, zero, _CMP_LE_OQ), _mm256_cmp_ps(x, _mm256_loadu_ps(p.boundX + i), _CMP_GE_OQ));
+        __m256 hitY = _mm256_or_ps(_mm256_cmp_ps(y, zero, _CMP_LE_OQ), _mm256_cmp_ps(y, _mm256_loadu_ps(p.boundY + i), _CMP_GE_OQ));
+
+        _mm256_storeu_ps(p.x + i, x);
+        _mm256_storeu_ps(p.y + i, y);
+        _mm256_storeu_ps(p.vx + i, _mm256_blendv_ps(vx, _mm256_xor_ps(vx, sign), hitX));
+        _mm256_storeu_ps(p.vy + i, _mm256_blendv_ps(vy, _mm256_xor_ps(vy, sign), hitY));
+    }
+
+    MoveParams tail = p;
+    tail.start = i;
+    moveScalar(tail);
+}
+
+TARGET_AVX2 void jiggleAVX2(const JiggleParams& p) {
+    const __m256i key = _mm256_set1_epi32((int)p.key);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    int i = p.start;
+    for (; i + 8 <= p.end; i += 8) {
+        __m256i counters = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)(p.ids + i)), 1);
+        __m256 amp = _mm256_loadu_ps(p.amplitude + i);
+        __m256 rx = randomSignedAVX2(_mm256_xor_si256(key, counters));
+        __m256 ry = randomSignedAVX2(_mm256_xor_si256(key, _mm256_add_epi32(counters, one)));
+
+        _mm256_storeu_ps(p.x + i, _mm256_add_ps(_mm256_loadu_ps(p.x + i), _mm256_mul_ps(amp, rx)));
+        _mm256_storeu_ps(p.y + i, _mm256_add_ps(_mm256_loadu_ps(p.y + i), _mm256_mul_ps(amp, ry)));
+    }
+
+    JiggleParams tail = p;
+    tail.start = i;
+    jiggleScalar(tail);
+}
+
+// --- AVX-512 (16 benzi, bounce cu registri masca) ---
+TARGET_AVX512 inline __m512 randomSignedAVX512(__m512i h) {
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(0x7feb352d));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((int)0x846ca68bU));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+    __m512 unit = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(h, 8)), _mm512_set1_ps(1.0f / 16777216.0f));
+    return _mm512_add_ps(_mm512_set1_ps(-1.0f), _mm512_mul_ps(unit, _mm512_set1_ps(2.0f)));
+}
+
+TARGET_AVX512 void moveAVX512(const MoveParams& p) {
+    const __m512 dt = _mm512_set1_ps(p.dt);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i sign = _mm512_set1_epi32((int)0x80000000U);
+
+    int i = p.start;
+    for (; i + 16 <= p.end; i += 16) {
+        __m512 vx = _mm512_loadu_ps(p.vx + i);
+        __m512 vy = _mm512_loadu_ps(p.vy + i);
+        __m512 x = _mm512_add_ps(_mm512_loadu_ps(p.x + i), _mm512_mul_ps(vx, dt));
+        __m512 y = _mm512_add_ps(_mm512_loadu_ps(p.y + i), _mm512_mul_ps(vy, dt));
+
+        __mmask16 hitX = _mm512_cmp_ps_mask(x, zero, _CMP_LE_OQ) | _mm512_cmp_ps_mask(x, _mm512_loadu_ps(p.boundX + i), _CMP_GE_OQ);
+        __mmask16 hitY = _mm512_cmp_ps_mask(y, zero, _CMP_LE_OQ) | _mm512_cmp_ps_mask(y, _mm512_loadu_ps(p.boundY + i), _CMP_GE_OQ);
+        __m512i vxBits = _mm512_castps_si512(vx);
+        __m512i vyBits = _mm512_castps_si512(vy);
+
+        _mm512_storeu_ps(p.x + i, x);
+        _mm512_storeu_ps(p.y + i, y);
+        _mm512_storeu_ps(p.vx + i, _mm512_castsi512_ps(_mm512_mask_xor_epi32(vxBits, hitX, vxBits, sign)));
+        _mm512_storeu_ps(p.vy + i, _mm512_castsi512_ps(_mm512_mask_xor_epi32(vyBits, hitY, vyBits, sign)));
+    }
+
+    MoveParams tail = p;
+    tail.start = i;
+    moveScalar(tail);
+}
+
+TARGET_AVX512 void jiggleAVX512(const JiggleParams& p) {
+    const __m512i key = _mm512_set1_epi32((int)p.key);
+    const __m512i one = _mm512_set1_epi32(1);
+
+    int i = p.start;
+    for (; i + 16 <= p.end; i += 16) {
+        __m512i counters = _mm512_slli_epi32(_mm512_loadu_si512((const void*)(p.ids + i)), 1);
+        __m512 amp = _mm512_loadu_ps(p.amplitude + i);
+        __m512 rx = randomSignedAVX512(_mm512_xor_si512(key, counters));
+        __m512 ry = randomSignedAVX512(_mm512_xor_si512(key, _mm512_add_epi32(counters, one)));
+
+        _mm512_storeu_ps(p.x + i, _mm512_add_ps(_mm512_loadu_ps(p.x + i), _mm512_mul_ps(amp, rx)));
+        _mm512_storeu_ps(p.y + i, _mm512_add_ps(_mm512_loadu_ps(p.y + i), _mm512_mul_ps(amp, ry)));
+    }
+
+    JiggleParams tail = p;
+    tail.start = i;
+    jiggleScalar(tail);
+}
+#endif
+
+MoveKernel selectMoveKernel(SimdLevel level) {
+#if defined(SIMD_X86)
+    switch (level) {
+    case SIMD_AVX512: return moveAVX512;
+    case SIMD_AVX2: return moveAVX2;
+    case SIMD_SSE2: return moveSSE2;
+    default: break;
+    }
+#endif
+    return moveScalar;
+}
+
+JiggleKernel selectJiggleKernel(SimdLevel level) {
+#if defined(SIMD_X86)
+    switch (level) {
+    case SIMD_AVX512: return jiggleAVX512;
+    case SIMD_AVX2: return jiggleAVX2;
+    case SIMD_SSE2: return jiggleSSE2;
+    default: break;
+    }
+#endif
+    return jiggleScalar;
+}
+
+// --- STEERING (STOL) ---
+// Forta de stol pentru N agenti, din sumele de vecini adunate de SteeringSystem:
+//  - separare: sum (p - pj) / d^2 (deja ponderata cu distanta)
+//  - aliniere: media vitezelor vecinilor - v
+//  - coeziune: media pozitiilor vecinilor - p
+//  - urmarire: spre jucator cu viteza maxima, doar sub STEER_PURSUIT_RADIUS
+// Forta e limitata la STEER_MAX_FORCE, viteza noua la [STEER_MIN_SPEED, STEER_MAX_SPEED].
+// Ca la move / jiggle, variantele SIMD fac aceleasi operatii in aceeasi ordine (sqrt si
+// impartire exacte, fara rsqrt), deci rezultatul e acelasi bit cu bit.
+const float STEER_RADIUS = 60.0f;           // < CELL_SIZE: vecinii sunt in 3x3 celule
+const int STEER_MAX_NEIGHBORS = 32;         // Costul per agent ramane limitat in grupuri dense
+const float STEER_PURSUIT_RADIUS = 400.0f;
+const float STEER_WEIGHT_SEPARATION = 20000.0f;
+const float STEER_WEIGHT_ALIGNMENT = 1.0f;
+const float STEER_WEIGHT_COHESION = 2.0f;
+const float STEER_WEIGHT_PURSUIT = 1.5f;
+const float STEER_MAX_FORCE = 600.0f;       // px / s^2
+const float STEER_MIN_SPEED = 80.0f;
+const float STEER_MAX_SPEED = 250.0f;
+
+struct SteerParams {
+    const float* x;
+    const float* y;
+    const float* vx;
+    const float* vy;
+    const float* sepX;
+    const float* sepY;
+    const float* sumVX;    // Suma vitezelor vecinilor
+    const float* sumVY;
+    const float* sumX;     // Suma pozitiilor vecinilor
+    const float* sumY;
+    const float* neighbors;
+    float* outVX;
+    float* outVY;
+    float targetX, targetY; // Jucatorul
+    float dt;
+    int start, end;
+};
+
+typedef void (*SteerKernel)(const SteerParams& p);
+
+void steerScalar(const SteerParams& p) {
+    const float pursuitSq = STEER_PURSUIT_RADIUS * STEER_PURSUIT_RADIUS;
+    for (int i = p.start; i < p.end; i++) {
+        float n = p.neighbors[i];
+        float inv = 1.0f / n;
+        bool flock = n > 0.0f;
+        float aliX = flock ? p.sumVX[i] * inv - p.vx[i] : 0.0f;
+        float aliY = flock ? p.sumVY[i] * inv - p.vy[i] : 0.0f;
+        float cohX = flock ? p.sumX[i] * inv - p.x[i] : 0.0f;
+        float cohY = flock ? p.sumY[i] * inv - p.y[i] : 0.0f;
+
+        float toX = p.targetX - p.x[i];
+        float toY = p.targetY - p.y[i];
+        float distSq = toX * toX + toY * toY;
+        bool chase = distSq < pursuitSq && distSq > 0.0001f;
+        float k = STEER_MAX_SPEED / sqrtf(distSq);
+        float purX = chase ? toX * k - p.vx[i] : 0.0f;
+        float purY = chase ? toY * k - p.vy[i] : 0.0f;
+
+        float fx = p.sepX[i] * STEER_WEIGHT_SEPARATION + aliX * STEER_WEIGHT_ALIGNMENT + cohX * STEER_WEIGHT_COHESION + purX * STEER_WEIGHT_PURSUIT;
+        float fy = p.sepY[i] * STEER_WEIGHT_SEPARATION + aliY * STEER_WEIGHT_ALIGNMENT + cohY * STEER_WEIGHT_COHESION + purY * STEER_WEIGHT_PURSUIT;
+        float forceLen = sqrtf(std::max(fx * fx + fy * fy, 0.0001f));
+        float forceScale = std::min(1.0f, STEER_MAX_FORCE / forceLen);
+
+        float nvx = p.vx[i] + fx * forceScale * p.dt;
+        float nvy = p.vy[i] + fy * forceScale * p.dt;
+        float speed = sqrtf(std::max(nvx * nvx + nvy * nvy, 0.0001f));
+        float speedScale = std::min(STEER_MAX_SPEED / speed, std::max(STEER_MIN_SPEED / speed, 1.0f));
+
+        p.outVX[i] = nvx * speedScale;
+        p.outVY[i] = nvy * speedScale;
+    }
+}
+
+#if defined(SIMD_X86)
+// Ramurile devin masti: valorile din benzile fara vecini / fara urmarire (inf, NaN din
+// 1/0) sunt anulate cu AND, ca 0.0f din varianta scalara
+void steerSSE2(const SteerParams& p) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 eps = _mm_set1_ps(0.0001f);
+    const __m128 pursuitSq = _mm_set1_ps(STEER_PURSUIT_RADIUS * STEER_PURSUIT_RADIUS);
+    const __m128 wSep = _mm_set1_ps(STEER_WEIGHT_SEPARATION);
+    const __m128 wAli = _mm_set1_ps(STEER_WEIGHT_ALIGNMENT);
+    const __m128 wCoh = _mm_set1_ps(STEER_WEIGHT_COHESION);
+    const __m128 wPur = _mm_set1_ps(STEER_WEIGHT_PURSUIT);
+    const __m128 maxForce = _mm_set1_ps(STEER_MAX_FORCE);
+    const __m128 minSpeed = _mm_set1_ps(STEER_MIN_SPEED);
+    const __m128 maxSpeed = _mm_set1_ps(STEER_MAX_SPEED);
+    const __m128 tx = _mm_set1_ps(p.targetX);
+    const __m128 ty = _mm_set1_ps(p.targetY);
+    const __m128 dt = _mm_set1_ps(p.dt);
+
+    int i = p.start;
+    for (; i + 4 <= p.end; i += 4) {
+        __m128 x = _mm_loadu_ps(p.x + i);
+        __m128 y = _mm_loadu_ps(p.y + i);
+        __m128 vx = _mm_loadu_ps(p.vx + i);
+        __m128 vy = _mm_loadu_ps(p.vy + i);
+
+        __m128 n = _mm_loadu_ps(p.neighbors + i);
+        __m128 inv = _mm_div_ps(one, n);
+        __m128 flock = _mm_cmpgt_ps(n, zero);
+        __m128 aliX = _mm_and_ps(flock, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(p.sumVX + i), inv), vx));
+        __m128 aliY = _mm_and_ps(flock, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(p.sumVY + i), inv), vy));
+        __m128 cohX = _mm_and_ps(flock, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(p.sumX + i), inv), x));
+        __m128 cohY = _mm_and_ps(flock, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(p.sumY + i), inv), y));
+
+        __m128 toX = _mm_sub_ps(tx, x);
+        __m128 toY = _mm_sub_ps(ty, y);
+        __m128 distSq = _mm_add_ps(_mm_mul_ps(toX, toX), _mm_mul_ps(toY, toY));
+        __m128 chase = _mm_and_ps(_mm_cmplt_ps(distSq, pursuitSq), _mm_cmpgt_ps(distSq, eps));
+        __m128 k = _mm_div_ps(maxSpeed, _mm_sqrt_ps(distSq));
+        __m128 purX = _mm_and_ps(chase, _mm_sub_ps(_mm_mul_ps(toX, k), vx));
+        __m128 purY = _mm_and_ps(chase, _mm_sub_ps(_mm_mul_ps(toY, k), vy));
+
+        __m128 fx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p.sepX + i), wSep), _mm_mul_ps(aliX, wAli)),
+            _mm_mul_ps(cohX, wCoh)), _mm_mul_ps(purX, wPur));
+        __m128 fy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p.sepY + i), wSep), _mm_mul_ps(aliY, wAli)),
+            _mm_mul_ps(cohY, wCoh)), _mm_mul_ps(purY, wPur));
+        __m128 forceLen = _mm_sqrt_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy)), eps));
+        __m128 forceScale = _mm_min_ps(one, _mm_div_ps(maxForce, forceLen));
+
+        __m128 nvx = _mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(fx, forceScale), dt));
+        __m128 nvy = _mm_add_ps(vy, _mm_mul_ps(_mm_mul_ps(fy, forceScale), dt));
+        __m128 speed = _mm_sqrt_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(nvx, nvx), _mm_mul_ps(nvy, nvy)), eps));
+        __m128 speedScale = _mm_min_ps(_mm_div_ps(maxSpeed, speed), _mm_max_ps(_mm_div_ps(minSpeed, speed), one));
+
+        _mm_storeu_ps(p.outVX + i, _mm_mul_ps(nvx, speedScale));
+        _mm_storeu_ps(p.outVY + i, _mm_mul_ps(nvy, speedScale));
+    }
+
+    SteerParams tail = p;
+    tail.start = i;
+    steerScalar(tail);
+}
+
+TARGET_AVX2 void steerAVX2(const SteerParams& p) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 eps = _mm256_set1_ps(0.0001f);
+    const __m256 pursuitSq = _mm256_set1_ps(STEER_PURSUIT_RADIUS * STEER_PURSUIT_RADIUS);
+    const __m256 wSep = _mm256_set1_ps(STEER_WEIGHT_SEPARATION);
+    const __m256 wAli = _mm256_set1_ps(STEER_WEIGHT_ALIGNMENT);
+    const __m256 wCoh = _mm256_set1_ps(STEER_WEIGHT_COHESION);
+    const __m256 wPur = _mm256_set1_ps(STEER_WEIGHT_PURSUIT);
+    const __m256 maxForce = _mm256_set1_ps(STEER_MAX_FORCE);
+    const __m256 minSpeed = _mm256_set1_ps(STEER_MIN_SPEED);
+    const __m256 maxSpeed = _mm256_set1_ps(STEER_MAX_SPEED);
+    const __m256 tx = _mm256_set1_ps(p.targetX);
+    const __m256 ty = _mm256_set1_ps(p.targetY);
+    const __m256 dt = _mm256_set1_ps(p.dt);
+
+    int i = p.start;
+    for (; i + 8 <= p.end; i += 8) {
+        __m256 x = _mm256_loadu_ps(p.x + i);
+        __m256 y = _mm256_loadu_ps(p.y + i);
+        __m256 vx = _mm256_loadu_ps(p.vx + i);
+        __m256 vy = _mm256_loadu_ps(p.vy + i);
+
+        __m256 n = _mm256_loadu_ps(p.neighbors + i);
+        __m256 inv = _mm256_div_ps(one, n);
+        __m256 flock = _mm256_cmp_ps(n, zero, _CMP_GT_OQ);
+        __m256 aliX = _mm256_and_ps(flock, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sumVX + i), inv), vx));
+        __m256 aliY = _mm256_and_ps(flock, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sumVY + i), inv), vy));
+        __m256 cohX = _mm256_and_ps(flock, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sumX + i), inv), x));
+        __m256 cohY = _mm256_and_ps(flock, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sumY + i), inv), y));
+
+        __m256 toX = _mm256_sub_ps(tx, x);
+        __m256 toY = _mm256_sub_ps(ty, y);
+        __m256 distSq = _mm256_add_ps(_mm256_mul_ps(toX, toX), _mm256_mul_ps(toY, toY));
+        __m256 chase = _mm256_and_ps(_mm256_cmp_ps(distSq, pursuitSq, _CMP_LT_OQ), _mm256_cmp_ps(distSq, eps, _CMP_GT_OQ));
+        __m256 k = _mm256_div_ps(maxSpeed, _mm256_sqrt_ps(distSq));
+        __m256 purX = _mm256_and_ps(chase, _mm256_sub_ps(_mm256_mul_ps(toX, k), vx));
+        __m256 purY = _mm256_and_ps(chase, _mm256_sub_ps(_mm256_mul_ps(toY, k), vy));
+
+        __m256 fx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sepX + i), wSep), _mm256_mul_ps(aliX, wAli)),
+            _mm256_mul_ps(cohX, wCoh)), _mm256_mul_ps(purX, wPur));
+        __m256 fy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(p.sepY + i), wSep), _mm256_mul_ps(aliY, wAli)),
+            _mm256_mul_ps(cohY, wCoh)), _mm256_mul_ps(purY, wPur));
+        __m256 forceLen = _mm256_sqrt_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(fx, fx), _mm256_mul_ps(fy, fy)), eps));
+        __m256 forceScale = _mm256_min_ps(one, _mm256_div_ps(maxForce, forceLen));
+
+        __m256 nvx = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_mul_ps(fx, forceScale), dt));
+        __m256 nvy = _mm256_add_ps(vy, _mm256_mul_ps(_mm256_mul_ps(fy, forceScale), dt));
+        __m256 speed = _mm256_sqrt_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(nvx, nvx), _mm256_mul_ps(nvy, nvy)), eps));
+        __m256 speedScale = _mm256_min_ps(_mm256_div_ps(maxSpeed, speed), _mm256_max_ps(_mm256_div_ps(minSpeed, speed), one));
+
+        _mm256_storeu_ps(p.outVX + i, _mm256_mul_ps(nvx, speedScale));
+        _mm256_storeu_ps(p.outVY + i, _mm256_mul_ps(nvy, speedScale));
+    }
+
+    SteerParams tail = p;
+    tail.start = i;
+    steerScalar(tail);
+}
+
+// Mastile sunt registri __mmask16: benzile fara vecini / urmarire raman 0 (maskz)
+TARGET_AVX512 void steerAVX512(const SteerParams& p) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 eps = _mm512_set1_ps(0.0001f);
+    const __m512 pursuitSq = _mm512_set1_ps(STEER_PURSUIT_RADIUS * STEER_PURSUIT_RADIUS);
+    const __m512 wSep = _mm512_set1_ps(STEER_WEIGHT_SEPARATION);
+    const __m512 wAli = _mm512_set1_ps(STEER_WEIGHT_ALIGNMENT);
+    const __m512 wCoh = _mm512_set1_ps(STEER_WEIGHT_COHESION);
+    const __m512 wPur = _mm512_set1_ps(STEER_WEIGHT_PURSUIT);
+    const __m512 maxForce = _mm512_set1_ps(STEER_MAX_FORCE);
+    const __m512 minSpeed = _mm512_set1_ps(STEER_MIN_SPEED);
+    const __m512 maxSpeed = _mm512_set1_ps(STEER_MAX_SPEED);
+    const __m512 tx = _mm512_set1_ps(p.targetX);
+    const __m512 ty = _mm512_set1_ps(p.targetY);
+    const __m512 dt = _mm512_set1_ps(p.dt);
+
+    int i = p.start;
+    for (; i + 16 <= p.end; i += 16) {
+        __m512 x = _mm512_loadu_ps(p.x + i);
+        __m512 y = _mm512_loadu_ps(p.y + i);
+        __m512 vx = _mm512_loadu_ps(p.vx + i);
+        __m512 vy = _mm512_loadu_ps(p.vy + i);
+
+        __m512 n = _mm512_loadu_ps(p.neighbors + i);
+        __m512 inv = _mm512_div_ps(one, n);
+        __mmask16 flock = _mm512_cmp_ps_mask(n, zero, _CMP_GT_OQ);
+        __m512 aliX = _mm512_maskz_sub_ps(flock, _mm512_mul_ps(_mm512_loadu_ps(p.sumVX + i), inv), vx);
+        __m512 aliY = _mm512_maskz_sub_ps(flock, _mm512_mul_ps(_mm512_loadu_ps(p.sumVY + i), inv), vy);
+        __m512 cohX = _mm512_maskz_sub_ps(flock, _mm512_mul_ps(_mm512_loadu_ps(p.sumX + i), inv), x);
+        __m512 cohY = _mm512_maskz_sub_ps(flock, _mm512_mul_ps(_mm512_loadu_ps(p.sumY + i), inv), y);
+
+        __m512 toX = _mm512_sub_ps(tx, x);
+        __m512 toY = _mm512_sub_ps(ty, y);
+        __m512 distSq = _mm512_add_ps(_mm512_mul_ps(toX, toX), _mm512_mul_ps(toY, toY));
+        __mmask16 chase = _mm512_cmp_ps_mask(distSq, pursuitSq, _CMP_LT_OQ) & _mm512_cmp_ps_mask(distSq, eps, _CMP_GT_OQ);
+        __m512 k = _mm512_div_ps(maxSpeed, _mm512_sqrt_ps(distSq));
+        __m512 purX = _mm512_maskz_sub_ps(chase, _mm512_mul_ps(toX, k), vx);
+        __m512 purY = _mm512_maskz_sub_ps(chase, _mm512_mul_ps(toY, k), vy);
+
+        __m512 fx = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(p.sepX + i), wSep), _mm512_mul_ps(aliX, wAli)),
+            _mm512_mul_ps(cohX, wCoh)), _mm512_mul_ps(purX, wPur));
+        __m512 fy = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(p.sepY + i), wSep), _mm512_mul_ps(aliY, wAli)),
+            _mm512_mul_ps(cohY, wCoh)), _mm512_mul_ps(purY, wPur));
+        __m512 forceLen = _mm512_sqrt_ps(_mm512_max_ps(_mm512_add_ps(_mm512_mul_ps(fx, fx), _mm512_mul_ps(fy, fy)), eps));
+        __m512 forceScale = _mm512_min_ps(one, _mm512_div_ps(maxForce, forceLen));
+
+        __m512 nvx = _mm512_add_ps(vx, _mm512_mul_ps(_mm512_mul_ps(fx, forceScale), dt));
+        __m512 nvy = _mm512_add_ps(vy, _mm512_mul_ps(_mm512_mul_ps(fy, forceScale), dt));
+        __m512 speed = _mm512_sqrt_ps(_mm512_max_ps(_mm512_add_ps(_mm512_mul_ps(nvx, nvx), _mm512_mul_ps(nvy, nvy)), eps));
+        __m512 speedScale = _mm512_min_ps(_mm512_div_ps(maxSpeed, speed), _mm512_max_ps(_mm512_div_ps(minSpeed, speed), one));
+
+        _mm512_storeu_ps(p.outVX + i, _mm512_mul_ps(nvx, speedScale));
+        _mm512_storeu_ps(p.outVY + i, _mm512_mul_ps(nvy, speedScale));
+    }
+
+    SteerParams tail = p;
+    tail.start = i;
+    steerScalar(tail);
+}
+#endif
+
+SteerKernel selectSteerKernel(SimdLevel level) {
+#if defined(SIMD_X86)
+    switch (level) {
+    case SIMD_AVX512: return steerAVX512;
+    case SIMD_AVX2: return steerAVX2;
+    case SIMD_SSE2: return steerSSE2;
+    default: break;
+    }
+#endif
+    return steerScalar;
+}
+
+// --- KERNELE PE LAYOUT ---
+// Intervalul [start, end) al unui tabel e impartit in bucati in care toate storage-urile
+// au x / y contigue (tot intervalul la SoA, un bloc la AoSoA) si fiecare bucata merge
+// prin kernel-ul SIMD. Un storage intercalat (AoS) trece prin bucla cu accesori, care
+// face aceleasi operatii ca moveScalar / jiggleScalar.
+template <typename P, typename V, typename B>
+void moveRange(P& pos, V& vel, const B& bound, float dt, int start, int end, MoveKernel kernel) {
+    int i = start;
+    while (i < end) {
+        size_t lanes = commonLanes((size_t)i, pos, vel, bound);
+        if (lanes == 0) break;
+        int n = (int)std::min(lanes, (size_t)(end - i));
+        MoveParams p = { pos.xPtr(i), pos.yPtr(i), vel.xPtr(i), vel.yPtr(i), bound.xPtr(i), bound.yPtr(i), dt, 0, n };
+        kernel(p);
+        i += n;
+    }
+
+    for (; i < end; i++) {
+        pos.x(i) += vel.x(i) * dt;
+        pos.y(i) += vel.y(i) * dt;
+        if (pos.x(i) <= 0 || pos.x(i) >= bound.x(i)) vel.x(i) *= -1;
+        if (pos.y(i) <= 0 || pos.y(i) >= bound.y(i)) vel.y(i) *= -1;
+    }
+}
+
+template <typename P>
+void jiggleRange(P& pos, const float* amplitude, const uint32_t* ids, uint32_t key, int start, int end, JiggleKernel kernel) {
+    int i = start;
+    while (i < end) {
+        size_t lanes = pos.lanes((size_t)i);
+        if (lanes == 0) break;
+        int n = (int)std::min(lanes, (size_t)(end - i));
+        JiggleParams p = { pos.xPtr(i), pos.yPtr(i), amplitude + i, ids + i, key, 0, n };
+        kernel(p);
+        i += n;
+    }
+
+    for (; i < end; i++) {
+        pos.x(i) += amplitude[i] * counterRandom(key, 2 * ids[i], -1.0f, 1.0f);
+        pos.y(i) += amplitude[i] * counterRandom(key, 2 * ids[i] + 1, -1.0f, 1.0f);
+    }
+}
+
+// ==========================================
+// 6. SISTEME
+// ==========================================
+
+// --- SCHEDULER ---
+// Fiecare sistem (sau etapa a unui sistem) declara ce componente citeste si scrie si pe
+// ce tabele lucreaza (query-ul). La fiecare pas schedulerul rezolva query-urile pe
+// arhetipurile existente si pune etapa j dupa etapa i < j daca:
+//  - ating cel putin un tabel comun si una scrie ce cealalta citeste / scrie, sau
+//  - una e structurala (creeaza / distruge entitati, deci muta randuri oriunde).
+// Etapele se grupeaza in valuri (nivelul in graf); etapele dintr-un val ruleaza in
+// paralel pe JobSystem, fiecare cu parallelFor-urile ei. Ordinea declararii ramane
+// ordinea logica, deci rezultatul e acelasi ca la rularea secventiala.
+// Cu contoare hardware (--perf) etapele ruleaza chiar secvential, ca fiecare sa aiba
+// doar evenimentele ei (parallelFor-urile din etapa raman paralele).
+const uint32_t ACCESS_PREVIOUS = 1U << 31; // Pozitia de la inceputul pasului (Archetype::prev)
+
+struct SystemAccess {
+    uint32_t query = 0;      // Tabelele care au toate componentele astea
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    bool structural = false;
+};
+
+class SystemScheduler {
+private:
+    struct Stage {
+        const char* name;
+        SystemAccess access;
+        std::function<void()> run;
+    };
+
+    std::vector<Stage> stages;
+    std::vector<std::vector<Archetype*>> stageTables; // Query-ul rezolvat in pasul curent
+    std::vector<int> stageLevel;
+    std::vector<std::vector<int>> waves;
+    const PerfCounters* perf = nullptr;
+    std::vector<PerfSample> stagePerf; // Suma pe pasii rulati cu contoare
+
+    bool sharesTable(size_t i, size_t j) const {
+        for (Archetype* a : stageTables[i]) {
+            if (std::find(stageTables[j].begin(), stageTables[j].end(), a) != stageTables[j].end()) return true;
+        }
+        return false;
+    }
+
+    bool conflicts(size_t i, size_t j) const {
+        const SystemAccess& a = stages[i].access;
+        const SystemAccess& b = stages[j].access;
+        if (a.structural || b.structural) return true;
+        bool dataHazard = (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+        return dataHazard && sharesTable(i, j);
+    }
+
+public:
+    void add(const char* name, const SystemAccess& access, std::function<void()> run) {
+        stages.push_back({ name, access, std::move(run) });
+    }
+
+    void run(const Registry& reg, JobSystem& jobs) {
+        size_t n = stages.size();
+        stageTables.resize(n);
+        stageLevel.assign(n, 0);
+        for (size_t i = 0; i < n; i++) reg.viewMask(stages[i].access.query).copyTo(stageTables[i]);
+
+        int levels = 0;
+        for (size_t j = 0; j < n; j++) {
+            for (size_t i = 0; i < j; i++) {
+                if (conflicts(i, j)) stageLevel[j] = std::max(stageLevel[j], stageLevel[i] + 1);
+            }
+            levels = std::max(levels, stageLevel[j] + 1);
+        }
+
+        waves.resize(levels);
+        for (auto& w : waves) w.clear();
+        for (size_t j = 0; j < n; j++) waves[stageLevel[j]].push_back((int)j);
+
+        if (perf) {
+            stagePerf.resize(n);
+            PerfSample before, after;
+            perf->read(before);
+            for (size_t i = 0; i < n; i++) {
+                stages[i].run();
+                perf->read(after);
+                accumulatePerf(stagePerf[i], before, after);
+                before = after;
+            }
+            return;
+        }
+
+        for (const std::vector<int>& wave : waves) {
+            jobs.parallelFor(0, (int)wave.size(), 1, [&](int start, int end) {
+                for (int k = start; k < end; k++) stages[wave[k]].run();
+            });
+        }
+    }
+
+    // null = inapoi la valuri paralele; sumele pornesc de la zero
+    void setPerfCounters(const PerfCounters* counters) {
+        perf = counters;
+        stagePerf.assign(stages.size(), PerfSample());
+    }
+
+    size_t stageCount() const { return stages.size(); }
+    const char* stageName(size_t i) const { return stages[i].name; }
+    const PerfSample& stagePerfTotal(size_t i) const { return stagePerf[i]; }
+
+    // Valurile din ultimul pas, ex. "[Input, Physics/move] -> [Gameplay]"
+    std::string describe() const {
+        std::string out;
+        for (size_t w = 0; w < waves.size(); w++) {
+            out += w > 0 ? " -> [" : "[";
+            for (size_t k = 0; k < waves[w].size(); k++) {
+                out += (k > 0 ? ", " : "") + std::string(stages[waves[w][k]].name);
+            }
+            out += "]";
+        }
+        return out;
+    }
+};
+
+// --- INPUT ---
+// Tastatura se citeste pe main (SDL), simularea primeste doar o masca de biti
+enum InputBit : uint32_t {
+    INPUT_UP = 1U << 0,
+    INPUT_DOWN = 1U << 1,
+    INPUT_LEFT = 1U << 2,
+    INPUT_RIGHT = 1U << 3
+};
+
+class InputSystem {
+public:
+    static uint32_t sample(const Uint8* keys) {
+        uint32_t input = 0;
+        if (keys[SDL_SCANCODE_W] || keys[SDL_SCANCODE_UP])    input |= INPUT_UP;
+        if (keys[SDL_SCANCODE_S] || keys[SDL_SCANCODE_DOWN])  input |= INPUT_DOWN;
+        if (keys[SDL_SCANCODE_A] || keys[SDL_SCANCODE_LEFT])  input |= INPUT_LEFT;
+        if (keys[SDL_SCANCODE_D] || keys[SDL_SCANCODE_RIGHT]) input |= INPUT_RIGHT;
+        return input;
+    }
+
+    static SystemAccess access() {
+        SystemAccess a;
+        a.query = ComponentMask<VelocityComponent>::value;
+        a.writes = ComponentMask<VelocityComponent>::value;
+        return a;
+    }
+
+    void update(Registry& reg, uint32_t input, Entity player) {
+        PROFILE_ZONE("Input");
+        if (!reg.has<VelocityComponent>(player)) return;
+
+        float speed = 350.0f;
+        VelocityComponent vel = { 0, 0 };
+
+        if (input & INPUT_UP)    vel.vy = -speed;
+        if (input & INPUT_DOWN)  vel.vy = speed;
+        if (input & INPUT_LEFT)  vel.vx = -speed;
+        if (input & INPUT_RIGHT) vel.vx = speed;
+
+        reg.set(player, vel);
+    }
+};
+
+// --- PHYSICS SYSTEM MULTI-THREADED ---
+class PhysicsSystem {
+public:
+    uint32_t seed = 0;
+    uint32_t frame = 0;
+    MoveKernel moveKernel = moveScalar;
+    JiggleKernel jiggleKernel = jiggleScalar;
+
+    void init(SimdLevel level) {
+        moveKernel = selectMoveKernel(level);
+        jiggleKernel = selectJiggleKernel(level);
+    }
+
+    // Move si jiggle sunt etape separate pentru scheduler: ating tabele diferite
+    // (monedele nu trec prin move, inamicii nu trec prin jiggle), deci pot rula in paralel
+    static SystemAccess moveAccess() {
+        SystemAccess a;
+        a.query = ComponentMask<TransformComponent, VelocityComponent, BoundsComponent>::value;
+        a.reads = ComponentMask<TransformComponent, VelocityComponent, BoundsComponent>::value;
+        a.writes = ComponentMask<TransformComponent, VelocityComponent>::value;
+        return a;
+    }
+
+    static SystemAccess jiggleAccess() {
+        SystemAccess a;
+        a.query = ComponentMask<TransformComponent, JiggleComponent>::value;
+        a.reads = ComponentMask<TransformComponent, JiggleComponent>::value;
+        a.writes = ComponentMask<TransformComponent>::value;
+        return a;
+    }
+
+    void update(Registry& reg, float dt, JobSystem& jobs) {
+        PROFILE_ZONE("Physics");
+        updateMove(reg, dt, jobs);
+        updateJiggle(reg, jobs);
+    }
+
+    void updateMove(Registry& reg, float dt, JobSystem& jobs) {
+        PROFILE_ZONE("Physics/move");
+        for (Archetype* a : reg.view<TransformComponent, VelocityComponent, BoundsComponent>()) {
+            jobs.parallelFor(0, a->count, grainFor(a->count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                PROFILE_ZONE("Physics/move chunk");
+                moveRange(a->pos, a->vel, a->bound, dt, start, end, moveKernel);
+            });
+        }
+    }
+
+    // Avanseaza frame-ul RNG-ului o data pe pas. Monedele adormite nu tremura.
+    void updateJiggle(Registry& reg, JobSystem& jobs) {
+        PROFILE_ZONE("Physics/jiggle");
+        uint32_t key = frameKey(seed, frame++);
+
+        for (Archetype* a : reg.view<TransformComponent, JiggleComponent>(COMP_SLEEPING)) {
+            jobs.parallelFor(0, a->count, grainFor(a->count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                PROFILE_ZONE("Physics/jiggle chunk");
+                jiggleRange(a->pos, a->jiggle.data(), a->entities.data(), key, start, end, jiggleKernel);
+            });
+        }
+    }
+
+private:
+    // Bucati destul de mari ca overhead-ul pe task sa fie neglijabil,
+    // destul de mici ca sa ramana ce fura la entitati putine
+    static int grainFor(int count, JobSystem& jobs) {
+        int grain = std::max(256, count / (jobs.threadCount() * 4));
+        return (grain + CACHE_LINE_ROWS - 1) / CACHE_LINE_ROWS * CACHE_LINE_ROWS;
+    }
+};
+
+// --- RENDER SNAPSHOT ---
+// Tot ce are nevoie render-ul dintr-un pas de simulare, copiat de pe thread-ul de
+// simulare: render-ul nu atinge Registry-ul sau grid-ul cat timp simularea ruleaza.
+// Fiecare sprite are pozitia de la inceputul si de la sfarsitul pasului, pentru
+// interpolare.
+struct SnapshotSprite {
+    float x, y;
+    float prevX, prevY;
+    int w, h;      // 0 = invizibil
+    Uint8 r, g, b;
+};
+
+struct HeatCell {
+    int cx, cy;
+    int count;
+};
+
+struct RenderSnapshot {
+    std::vector<SnapshotSprite> sprites;
+    std::vector<HeatCell> heatCells;
+    float playerX = 0, playerY = 0, playerPrevX = 0, playerPrevY = 0;
+    int score = 0;
+    bool gameOver = false;
+    int entityCount = 0;
+    uint64_t step = 0;       // Pasul de simulare
+    bool recording = false;  // F5: se inregistreaza un replay
+    BroadphaseMode broadphase = BROADPHASE_GRID; // 'G'
+    int sleeping = -1;       // 'Z': monede adormite (-1 = somn oprit)
+    Uint64 publishTime = 0;  // SDL_GetPerformanceCounter la publicare
+};
+
+// --- SOMN (--sleep / 'Z') ---
+// Monedele cu RestComponent numara pasii consecutivi in care separarea le-a impins cu
+// mai putin de SLEEP_PUSH (jiggle-ul e zgomot pe loc, nu se pune); dupa SLEEP_STEPS
+// adorm: primesc tag-ul SleepingComponent si trec in alt arhetip, pe care jiggle-ul,
+// prev-ul si grid-ul din fiecare pas il sar. O moneda treaza care intra intr-una
+// adormita e impinsa de ea ca de un obstacol fix si o trezeste (de la pasul urmator
+// se misca amandoua); jucatorul le colecteaza si adormite.
+const float SLEEP_PUSH = 0.05f;
+const uint32_t SLEEP_STEPS = 30;
+
+inline int worldToCell(float v) { return (int)floorf(v / CELL_SIZE); }
+
+inline uint32_t cellHash(int cx, int cy) {
+    return hashMix((uint32_t)cx * 0x9E3779B1U ^ (uint32_t)cy * 0x85EBCA77U);
+}
+
+// Monedele adormite nu se misca, deci stau intr-un hash separat de liste pe celule,
+// actualizat incremental: un nod intra cand moneda adoarme si iese cand se trezeste
+// sau e colectata, fara nicio munca in pasii fara schimbari. In fiecare bucket nodurile
+// sunt ordonate dupa entitate, deci ordinea nu depinde de istoric (acelasi rezultat si
+// dupa un snapshot incarcat, cand hash-ul e refacut din tabele).
+class SleepGrid {
+public:
+    struct Node {
+        float x, y, radius;
+        Uint8 type;
+        Entity entity;   // INVALID_ENTITY = nod liber
+        int cx, cy;
+        int next;        // Urmatorul nod din bucket (-1 = final)
+    };
+
+private:
+    uint32_t bucketCount = 0;
+    std::vector<int> heads;        // Primul nod din fiecare bucket
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    std::vector<int> nodeOfSlot;   // Slotul entitatii -> nod (-1)
+    int count = 0;
+    float maxNodeRadius = 0.0f;
+
+    uint32_t bucketOf(int cx, int cy) const { return cellHash(cx, cy) & (bucketCount - 1); }
+
+    void link(int n) {
+        int* at = &heads[bucketOf(nodes[n].cx, nodes[n].cy)];
+        while (*at >= 0 && nodes[*at].entity < nodes[n].entity) at = &nodes[*at].next;
+        nodes[n].next = *at;
+        *at = n;
+    }
+
+    void rehash(uint32_t buckets) {
+        bucketCount = buckets;
+        heads.assign(buckets, -1);
+        for (int n = 0; n < (int)nodes.size(); n++) {
+            if (nodes[n].entity != INVALID_ENTITY) link(n);
+        }
+    }
+
+public:
+    int size() const { return count; }
+    float maxRadius() const { return maxNodeRadius; }
+
+    void clear() {
+        bucketCount = 0;
+        heads.clear();
+        nodes.clear();
+        freeNodes.clear();
+        nodeOfSlot.clear();
+        count = 0;
+        maxNodeRadius = 0.0f;
+    }
+
+    // Un bucket per nod, rotunjit la putere a lui 2 (ca grid-ul din GameplaySystem)
+    void insert(Entity e, float x, float y, float radius, Uint8 type) {
+        if ((uint32_t)count + 1 > bucketCount) rehash(std::max(1024U, bucketCount * 2));
+
+        int n;
+        if (!freeNodes.empty()) {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+        }
+        else {
+            n = (int)nodes.size();
+            nodes.push_back(Node());
+        }
+        nodes[n] = { x, y, radius, type, e, worldToCell(x), worldToCell(y), -1 };
+        link(n);
+
+        uint32_t slot = e & ENTITY_INDEX_MASK;
+        if (slot >= nodeOfSlot.size()) nodeOfSlot.resize((size_t)slot + 1, -1);
+        nodeOfSlot[slot] = n;
+        maxNodeRadius = std::max(maxNodeRadius, radius);
+        count++;
+    }
+
+    // False daca entitatea nu e in hash
+    bool remove(Entity e) {
+        uint32_t slot = e & ENTITY_INDEX_MASK;
+        if (slot >= nodeOfSlot.size() || nodeOfSlot[slot] < 0 || nodes[nodeOfSlot[slot]].entity != e) return false;
+
+        int n = nodeOfSlot[slot];
+        int* at = &heads[bucketOf(nodes[n].cx, nodes[n].cy)];
+        while (*at != n) at = &nodes[*at].next;
+        *at = nodes[n].next;
+
+        nodes[n].entity = INVALID_ENTITY;
+        freeNodes.push_back(n);
+        nodeOfSlot[slot] = -1;
+        count--;
+        return true;
+    }
+
+    template <typename Fn>
+    void forEachInCell(int cx, int cy, Fn&& fn) const {
+        if (count == 0) return;
+        for (int n = heads[bucketOf(cx, cy)]; n >= 0; n = nodes[n].next) {
+            if (nodes[n].cx == cx && nodes[n].cy == cy) fn(nodes[n]);
+        }
+    }
+
+    int countInCell(int cx, int cy) const {
+        int n = 0;
+        forEachInCell(cx, cy, [&](const Node&) { n++; });
+        return n;
+    }
+
+    // fn(cx, cy, numar) pentru fiecare celula ocupata, o singura data
+    template <typename Fn>
+    void forEachCell(Fn&& fn) const {
+        if (count == 0) return;
+        for (uint32_t b = 0; b < bucketCount; b++) {
+            for (int n = heads[b]; n >= 0; n = nodes[n].next) {
+                bool seen = false;
+                for (int k = heads[b]; k != n && !seen; k = nodes[k].next) {
+                    seen = nodes[k].cx == nodes[n].cx && nodes[k].cy == nodes[n].cy;
+                }
+                if (!seen) fn(nodes[n].cx, nodes[n].cy, countInCell(nodes[n].cx, nodes[n].cy));
+            }
+        }
+    }
+};
+
+// --- SPATIAL QUERIES (pe grid-ul GameplaySystem) ---
+// Un lot de interogari, rulat cu GameplaySystem::runQueries dupa update:
+//  - QUERY_RADIUS:  entitatile al caror collider atinge cercul (x, y, radius)
+//  - QUERY_BOX:     entitatile al caror collider atinge dreptunghiul [minX, maxX] x [minY, maxY]
+//  - QUERY_NEAREST: cele mai apropiate k centre de (x, y), la distanta < radius, crescator
+// typeMask filtreaza dupa tip (bitul 1 << EntityType, 0 = toate), `ignore` sare o entitate
+// (de obicei cea care intreaba). Rezultatele stau toate in `hits`: interogarea q are
+// hits[hitStart[q], hitStart[q] + hitCount[q]). Vectorii se refolosesc de la un lot la
+// altul, deci dupa primele frame-uri nu se mai aloca nimic.
+enum SpatialQueryKind { QUERY_RADIUS, QUERY_BOX, QUERY_NEAREST };
+
+struct SpatialQuery {
+    SpatialQueryKind kind;
+    float x, y, radius;           // RADIUS / NEAREST
+    float minX, minY, maxX, maxY; // BOX
+    int k;                        // NEAREST
+    uint32_t typeMask;
+    Entity ignore;
+};
+
+struct SpatialHit {
+    Entity entity;
+    float x, y;    // Pozitia din grid (dupa separarea monedelor)
+    float distSq;  // Fata de centrul interogarii (BOX: centrul dreptunghiului)
+};
+
+inline uint32_t typeBit(EntityType type) { return 1U << type; }
+
+class SpatialQueryBatch {
+private:
+    friend class GameplaySystem;
+    std::vector<uint64_t> order;                   // (bucket << 32) | index, ordinea de executie
+    std::vector<std::vector<SpatialHit>> blockHits; // Rezultatele fiecarui bloc, concatenate la final
+
+    int add(const SpatialQuery& q) {
+        queries.push_back(q);
+        return (int)queries.size() - 1;
+    }
+
+public:
+    static const int MAX_NEAREST = 64;
+
+    std::vector<SpatialQuery> queries;
+    std::vector<SpatialHit> hits;
+    std::vector<int> hitStart, hitCount;
+
+    void clear() { queries.clear(); }
+    int size() const { return (int)queries.size(); }
+
+    // Intorc indexul interogarii in lot
+    int addRadius(float x, float y, float radius, uint32_t typeMask = 0, Entity ignore = INVALID_ENTITY) {
+        return add({ QUERY_RADIUS, x, y, radius, 0, 0, 0, 0, 0, typeMask, ignore });
+    }
+
+    int addBox(float minX, float minY, float maxX, float maxY, uint32_t typeMask = 0, Entity ignore = INVALID_ENTITY) {
+        return add({ QUERY_BOX, (minX + maxX) * 0.5f, (minY + maxY) * 0.5f, 0, minX, minY, maxX, maxY, 0, typeMask, ignore });
+    }
+
+    int addNearest(float x, float y, int k, float maxRadius, uint32_t typeMask = 0, Entity ignore = INVALID_ENTITY) {
+        int limit = MAX_NEAREST; // Copie: std::min ia referinte, iar MAX_NEAREST nu are definitie
+        return add({ QUERY_NEAREST, x, y, maxRadius, 0, 0, 0, 0, std::max(0, std::min(k, limit)), typeMask, ignore });
+    }
+
+    const SpatialHit* begin(int q) const { return hits.data() + hitStart[q]; }
+    const SpatialHit* end(int q) const { return hits.data() + hitStart[q] + hitCount[q]; }
+};
+
+// --- GAMEPLAY SYSTEM (Spatial Hash + Coin Physics + Heatmap Data) ---
+// Lumea nu are margini pentru grid: celula (cx, cy) e orice pereche de intregi, iar
+// celulele ocupate sunt puse intr-un spatial hash cu tableSize bucket-uri (putere a
+// lui 2, ~o entitate per bucket). Memoria depinde de numarul de entitati, nu de aria
+// lumii. Doua celule diferite pot cadea in acelasi bucket, deci cine citeste un
+// bucket filtreaza dupa coordonatele celulei (forEachInCell).
+//
+// Hash-ul e reconstruit in fiecare frame: cheile (bucket-ul fiecarei entitati) sunt
+// sortate cu un radix sort LSD stabil pe cifre de RADIX_BITS, apoi pozitiile / razele
+// / tipurile sunt copiate in ordinea bucket-urilor. Rezultatul nu depinde de numarul
+// de thread-uri: blocurile sunt fixe, offset-urile se dau in ordinea blocurilor, iar
+// separarea aduna intai deplasarile intr-un buffer separat si le aplica dupa.
+//
+// Intrarea e query-ul <Transform, Collider>, parcurs pe fiecare tabel de arhetip, fara
+// tabelele monedelor adormite: ele stau in SleepGrid (actualizat incremental), deci
+// reconstruirea costa cat entitatile treze. Interogarile si separarea citesc din ambele.
+// Alte sisteme citesc grid-ul prin loturi de interogari (runQueries, SpatialQueryBatch);
+// contactele jucatorului sunt si ele un astfel de lot.
+//
+// Broadphase-ul coliziunilor (separarea monedelor + contactele jucatorului) e ales la
+// rulare: grid-ul de mai sus, sau sort-and-sweep pe axa x (BROADPHASE_SWEEP) cu test
+// continuu intre pozitia de la inceputul pasului (prev) si cea curenta. Grid-ul se
+// construieste in ambele moduri (heatmap, SteeringSystem). Somnul merge doar cu grid-ul.
+class GameplaySystem {
+private:
+    friend class SteeringSystem; // Citeste vecinii direct din sloturile sortate
+    static const int BUILD_BLOCK = 4096;      // Entitati per histograma locala
+    static const int RADIX_BITS = 11;
+    static const int RADIX_SIZE = 1 << RADIX_BITS;
+    static const int SWEEP_SHIFT_BUDGET = 16;  // Mutari per entitate inainte de std::sort
+    static const int QUERY_BLOCK = 64;         // Interogari per bloc in runQueries
+
+    struct BuildBlock {
+        int table;         // Indexul in `tables`
+        int rowStart, rowEnd;
+        int flatStart;     // Pozitia primului rand in sortKeys
+    };
+
+    std::vector<Archetype*> tables;
+    std::vector<int> tableFlatStart; // Primul index plat al fiecarui tabel
+    std::vector<BuildBlock> blocks;
+
+    uint32_t tableSize = 0;           // Numarul de bucket-uri
+    std::vector<int> bucketStart;     // tableSize + 1; bucket b = [bucketStart[b], bucketStart[b + 1])
+    std::vector<uint32_t> sortKeys, sortKeysTmp; // Bucket-ul fiecarei entitati (tableSize = exclusa)
+    std::vector<uint32_t> sortRefs, sortRefsTmp; // Indexul plat al entitatii
+    std::vector<int> blockOffsets;    // numBlocks * RADIX_SIZE: histograma, apoi cursorul fiecarui bloc
+
+    // Date ordonate pe bucket-uri
+    AlignedVector<float> cellX, cellY;
+    AlignedVector<float> cellRadius;
+    std::vector<Uint8> cellType;
+    std::vector<int> cellTable, cellRow; // De unde vine slotul
+    std::vector<int> flatSlot;           // Inversul lui sortRefs: slotul fiecarui index plat (-1 = nu e in grid)
+    std::vector<Entity> cellEntity;
+    float maxCellRadius = 0.0f;          // Cel mai mare collider din grid (raza de cautare)
+    std::vector<int> slotCellX, slotCellY;
+    AlignedVector<float> pushX, pushY; // Deplasarea acumulata din separare
+    std::vector<Entity> pendingDestroy;
+    SpatialQueryBatch playerQuery;
+
+    // Somn (doar broadphase-ul grid): monedele adormite stau in `sleepers`, nu in grid
+    SleepGrid sleepers;
+    std::vector<Entity> wakeList, sleepList; // Schimbarile din pasul curent, sortate
+    std::mutex sleepLock;                    // Pt listele de mai sus, din separateCoins
+
+    // --- SORT-AND-SWEEP (BROADPHASE_SWEEP) ---
+    struct SweepEntry {
+        float minX;
+        Entity entity;
+        Archetype* table; // null = entitatea nu mai e in query (pasul trecut)
+        int row;
+    };
+
+    struct SweepPair { int a, b; }; // Pozitii in ordinea sortata, a < b
+
+    std::vector<Entity> sweepOrder;          // Ordinea sortata de la pasul trecut
+    std::vector<SweepEntry> sweepEntries, sweepCandidates;
+    std::vector<uint32_t> sweepStamp;        // Pe slot de entitate: pasul in care a intrat in lista
+    uint32_t sweepFrame = 0;
+    AlignedVector<float> sweepMinX, sweepMaxX, sweepMinY, sweepMaxY;
+    AlignedVector<float> sweepX0, sweepY0, sweepX1, sweepY1, sweepRadius;
+    AlignedVector<float> sweepPushX, sweepPushY;
+    std::vector<Uint8> sweepType;
+    std::vector<std::vector<SweepPair>> blockPairs;
+    std::vector<SweepPair> sweepPairs;
+    int sweepPlayer = -1;                    // Pozitia jucatorului in ordinea sortata
+
+    uint32_t bucketOf(int cx, int cy) const { return cellHash(cx, cy) & (tableSize - 1); }
+
+    // Apeleaza fn(slot) pentru fiecare entitate din celula (cx, cy)
+    template <typename Fn>
+    void forEachInCell(int cx, int cy, Fn&& fn) const {
+        if (tableSize == 0) return;
+        uint32_t b = bucketOf(cx, cy);
+        for (int slot = bucketStart[b]; slot < bucketStart[b + 1]; slot++) {
+            if (slotCellX[slot] == cx && slotCellY[slot] == cy) fn(slot);
+        }
+    }
+
+    // Un pas de radix sort stabil pe cifra de la `shift`, din (keys, refs) in (outKeys, outRefs)
+    void radixPass(int count, int shift, const uint32_t* keys, const uint32_t* refs,
+        uint32_t* outKeys, uint32_t* outRefs, JobSystem& jobs) {
+        int numBlocks = (count + BUILD_BLOCK - 1) / BUILD_BLOCK;
+        blockOffsets.assign((size_t)numBlocks * RADIX_SIZE, 0);
+
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                int* hist = &blockOffsets[(size_t)blk * RADIX_SIZE];
+                int end = std::min(count, (blk + 1) * BUILD_BLOCK);
+                for (int i = blk * BUILD_BLOCK; i < end; i++) hist[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+            }
+        });
+
+        // Prefix sum pe (cifra, bloc): fiecare bloc primeste cursorul lui pt fiecare cifra
+        int running = 0;
+        for (int d = 0; d < RADIX_SIZE; d++) {
+            for (int blk = 0; blk < numBlocks; blk++) {
+                int& slot = blockOffsets[(size_t)blk * RADIX_SIZE + d];
+                int n = slot;
+                slot = running;
+                running += n;
+            }
+        }
+
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                int* cursor = &blockOffsets[(size_t)blk * RADIX_SIZE];
+                int end = std::min(count, (blk + 1) * BUILD_BLOCK);
+                for (int i = blk * BUILD_BLOCK; i < end; i++) {
+                    int slot = cursor[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+                    outKeys[slot] = keys[i];
+                    outRefs[slot] = refs[i];
+                }
+            }
+        });
+    }
+
+    // Impingerea monedei a de catre b (sloturi sortate), adunata in (outX, outY)
+    void accumulatePush(int a, int b, float& outX, float& outY) const {
+        if (cellType[b] != TYPE_COIN) return;
+        separationPush(cellX[a] - cellX[b], cellY[a] - cellY[b], cellRadius[a] + cellRadius[b], outX, outY);
+    }
+
+    // Impingerea unei monede de catre alta aflata la (dx, dy) = a - b (grid si sweep);
+    // true daca se suprapun
+    static bool separationPush(float dx, float dy, float rTotal, float& outX, float& outY) {
+        if (abs(dx) < 20 && abs(dy) < 20) {
+            float distSq = dx * dx + dy * dy;
+
+            if (distSq < rTotal * rTotal && distSq > 0.0001f) {
+                float dist = sqrt(distSq);
+                float overlap = rTotal - dist;
+                float nx = dx / dist;
+                float ny = dy / dist;
+                float separationForce = overlap * 0.5f;
+
+                outX += nx * separationForce;
+                outY += ny * separationForce;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Test continuu: cercurile se misca liniar de la (x0, y0) la (x1, y1) in pas.
+    // Distanta minima a miscarii relative e la t = -(d . m) / (m . m), taiat la [0, 1],
+    // deci o trecere rapida prin celalalt cerc nu mai e ratata intre doua pozitii.
+    static bool sweptOverlap(float ax0, float ay0, float ax1, float ay1,
+        float bx0, float by0, float bx1, float by1, float rTotal) {
+        float dx = ax0 - bx0;
+        float dy = ay0 - by0;
+        float mx = (ax1 - ax0) - (bx1 - bx0);
+        float my = (ay1 - ay0) - (by1 - by0);
+        float mm = mx * mx + my * my;
+        float t = mm > 1e-8f ? std::max(0.0f, std::min(1.0f, -(dx * mx + dy * my) / mm)) : 0.0f;
+        float cx = dx + mx * t;
+        float cy = dy + my * t;
+        return cx * cx + cy * cy < rTotal * rTotal;
+    }
+
+public:
+    int score = 0;
+    bool gameOver = false;
+    BroadphaseMode broadphase = BROADPHASE_GRID;
+
+    // Statistici sweep din ultimul pas (--headless)
+    int sweepPairCount = 0;
+    long long sweepShifts = 0; // Mutari in insertion sort
+    bool sweepFullSort = false; // Insertion sort-ul a depasit bugetul -> std::sort
+
+    int sleepingCount() const { return sleepers.size(); }
+
+    // Coordonate de celula in lume
+    int getCountInCell(int cx, int cy) const {
+        int n = sleepers.countInCell(cx, cy);
+        forEachInCell(cx, cy, [&](int) { n++; });
+        return n;
+    }
+
+    // Celulele ocupate, pentru heatmap. Intr-un bucket pot sta mai multe celule:
+    // fiecare celula e emisa la prima ei aparitie in bucket.
+    void exportHeatmap(std::vector<HeatCell>& out) const {
+        out.clear();
+        int gridCount = (int)cellX.size();
+        for (int s = 0; s < gridCount; s++) {
+            int first = bucketStart[sortKeys[s]];
+            int last = bucketStart[sortKeys[s] + 1];
+            int cx = slotCellX[s], cy = slotCellY[s];
+
+            bool seen = false;
+            for (int k = first; k < s && !seen; k++) seen = slotCellX[k] == cx && slotCellY[k] == cy;
+            if (seen) continue;
+
+            int n = sleepers.countInCell(cx, cy);
+            for (int k = s; k < last; k++) n += (slotCellX[k] == cx && slotCellY[k] == cy) ? 1 : 0;
+            out.push_back({ cx, cy, n });
+        }
+
+        // Celulele doar cu monede adormite
+        sleepers.forEachCell([&](int cx, int cy, int n) {
+            bool awake = false;
+            forEachInCell(cx, cy, [&](int) { awake = true; });
+            if (!awake) out.push_back({ cx, cy, n });
+        });
+    }
+
+    // Ruleaza lotul pe grid-ul din ultimul update. Interogarile se executa sortate dupa
+    // bucket-ul celulei din centru (cele apropiate citesc aceleasi sloturi, calde in
+    // cache), pe blocuri fixe de QUERY_BLOCK; rezultatele se concateneaza in ordinea
+    // blocurilor, deci nu depind de numarul de thread-uri. Entitatile distruse dupa
+    // construirea grid-ului (monedele colectate) sunt sarite.
+    void runQueries(const Registry& reg, SpatialQueryBatch& batch, JobSystem& jobs) const {
+        PROFILE_ZONE("Gameplay/queries");
+        int n = batch.size();
+        batch.order.resize(n);
+        batch.hitStart.resize(n);
+        batch.hitCount.resize(n);
+        for (int q = 0; q < n; q++) {
+            const SpatialQuery& query = batch.queries[q];
+            uint32_t key = tableSize ? bucketOf(worldToCell(query.x), worldToCell(query.y)) : 0;
+            batch.order[q] = ((uint64_t)key << 32) | (uint32_t)q;
+        }
+        std::sort(batch.order.begin(), batch.order.end());
+
+        int numBlocks = (n + QUERY_BLOCK - 1) / QUERY_BLOCK;
+        batch.blockHits.resize(numBlocks);
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                std::vector<SpatialHit>& out = batch.blockHits[blk];
+                out.clear();
+                int end = std::min(n, (blk + 1) * QUERY_BLOCK);
+                for (int i = blk * QUERY_BLOCK; i < end; i++) {
+                    int q = (int)(batch.order[i] & 0xFFFFFFFFU);
+                    int start = (int)out.size();
+                    const SpatialQuery& query = batch.queries[q];
+                    if (query.kind == QUERY_RADIUS) queryRadius(reg, query, out);
+                    else if (query.kind == QUERY_BOX) queryBox(reg, query, out);
+                    else queryNearest(reg, query, out);
+                    batch.hitStart[q] = start;
+                    batch.hitCount[q] = (int)out.size() - start;
+                }
+            }
+        });
+
+        batch.hits.clear();
+        for (int blk = 0; blk < numBlocks; blk++) {
+            int base = (int)batch.hits.size();
+            int end = std::min(n, (blk + 1) * QUERY_BLOCK);
+            for (int i = blk * QUERY_BLOCK; i < end; i++) batch.hitStart[batch.order[i] & 0xFFFFFFFFU] += base;
+            batch.hits.insert(batch.hits.end(), batch.blockHits[blk].begin(), batch.blockHits[blk].end());
+        }
+    }
+
+    // Muta monedele, opreste / coloreaza jucatorul, distruge monedele colectate si
+    // adoarme / trezeste monedele (somn)
+    static SystemAccess access() {
+        SystemAccess a;
+        a.query = ComponentMask<TransformComponent, ColliderComponent>::value;
+        a.reads = ComponentMask<TransformComponent, ColliderComponent, SpriteComponent, RestComponent>::value;
+        a.writes = ComponentMask<TransformComponent, VelocityComponent, SpriteComponent, RestComponent>::value;
+        a.structural = true;
+        return a;
+    }
+
+    void update(Registry& reg, Entity player, JobSystem& jobs) {
+        if (gameOver) return;
+
+        syncSleepers(reg);
+        if (broadphase == BROADPHASE_SWEEP && sleepers.size() > 0) wakeAll(reg);
+        int count = clear(reg);
+        populate(player, jobs);
+        int gridCount = sortByBucket(count, jobs);
+        if (broadphase == BROADPHASE_SWEEP) {
+            buildSweep(reg, jobs);
+            findSweepPairs(player, jobs);
+            sweepContacts(reg, player);
+            separateSweep(jobs);
+            for (Entity e : pendingDestroy) reg.destroyEntity(e);
+        }
+        else {
+            separateCoins(gridCount, jobs);
+            queryPlayer(reg, player, jobs);
+            updateSleep(reg);
+        }
+    }
+
+private:
+    // 1. CLEAR - blocuri fixe pe fiecare tabel (nu depind de numarul de thread-uri) si
+    // un bucket per entitate (rotunjit la putere a lui 2). Intoarce numarul de entitati.
+    int clear(Registry& reg) {
+        PROFILE_ZONE("Gameplay/clear");
+        // Adormitele sunt in `sleepers`, cele inactive nu intra deloc
+        reg.view<TransformComponent, ColliderComponent>(COMP_SLEEPING | COMP_INACTIVE).copyTo(tables);
+        tableFlatStart.resize(tables.size());
+        blocks.clear();
+        int count = 0;
+        for (int t = 0; t < (int)tables.size(); t++) {
+            tableFlatStart[t] = count;
+            for (int row = 0; row < tables[t]->count; row += BUILD_BLOCK) {
+                BuildBlock b = { t, row, std::min(tables[t]->count, row + BUILD_BLOCK), count + row };
+                blocks.push_back(b);
+            }
+            count += tables[t]->count;
+        }
+
+        tableSize = 1024;
+        while ((int)tableSize < count) tableSize <<= 1;
+        sortKeys.resize(count);
+        sortRefs.resize(count);
+        sortKeysTmp.resize(count);
+        sortRefsTmp.resize(count);
+        return count;
+    }
+
+    // 2. POPULATE - cheia fiecarei entitati; jucatorul primeste tableSize (ajunge la final)
+    void populate(Entity player, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/populate");
+        jobs.parallelFor(0, (int)blocks.size(), 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                const BuildBlock& b = blocks[blk];
+                const Archetype& a = *tables[b.table];
+                uint32_t* keys = &sortKeys[b.flatStart - b.rowStart];
+                uint32_t* refs = &sortRefs[b.flatStart - b.rowStart];
+
+                for (int i = b.rowStart; i < b.rowEnd; i++) {
+                    refs[i] = (uint32_t)(b.flatStart - b.rowStart + i);
+                    keys[i] = a.entities[i] == player ? tableSize : bucketOf(worldToCell(a.pos.x(i)), worldToCell(a.pos.y(i)));
+                }
+            }
+        });
+    }
+
+    // Radix sort + inceputul bucket-urilor + copiile ordonate. Intoarce cate entitati
+    // sunt in hash.
+    int sortByBucket(int count, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/sort");
+
+        // Radix sort stabil: entitatile raman in ordinea (tabel, rand) in fiecare bucket
+        int keyBits = 1;
+        while ((1U << keyBits) <= tableSize) keyBits++;
+        for (int shift = 0; shift < keyBits; shift += RADIX_BITS) {
+            radixPass(count, shift, sortKeys.data(), sortRefs.data(), sortKeysTmp.data(), sortRefsTmp.data(), jobs);
+            sortKeys.swap(sortKeysTmp);
+            sortRefs.swap(sortRefsTmp);
+        }
+
+        int gridCount = (int)(std::lower_bound(sortKeys.begin(), sortKeys.end(), tableSize) - sortKeys.begin());
+
+        // Inceputul fiecarui bucket: fiecare granita de cheie scrie bucket-urile dintre
+        // cheia anterioara si cea curenta, deci fiecare bucket e scris o singura data
+        bucketStart.resize((size_t)tableSize + 1);
+        jobs.parallelFor(0, gridCount + 1, 4096, [&](int start, int end) {
+            for (int i = start; i < end; i++) {
+                int64_t prev = (i == 0) ? -1 : (int64_t)sortKeys[i - 1];
+                int64_t cur = (i == gridCount) ? (int64_t)tableSize : (int64_t)sortKeys[i];
+                for (int64_t b = prev + 1; b <= cur; b++) bucketStart[(size_t)b] = i;
+            }
+        });
+
+        cellX.resize(gridCount);
+        cellY.resize(gridCount);
+        cellRadius.resize(gridCount);
+        cellType.resize(gridCount);
+        cellTable.resize(gridCount);
+        cellRow.resize(gridCount);
+        cellEntity.resize(gridCount);
+        slotCellX.resize(gridCount);
+        slotCellY.resize(gridCount);
+        pushX.resize(gridCount);
+        pushY.resize(gridCount);
+
+        // Gather in ordinea bucket-urilor
+        jobs.parallelFor(0, gridCount, grainFor(gridCount, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+            for (int slot = start; slot < end; slot++) {
+                int flat = (int)sortRefs[slot];
+                int t = (int)(std::upper_bound(tableFlatStart.begin(), tableFlatStart.end(), flat) - tableFlatStart.begin()) - 1;
+                const Archetype& a = *tables[t];
+                int i = flat - tableFlatStart[t];
+
+                cellX[slot] = a.pos.x(i);
+                cellY[slot] = a.pos.y(i);
+                cellRadius[slot] = a.colliders[i].radius;
+                cellType[slot] = (Uint8)a.colliders[i].type;
+                cellTable[slot] = t;
+                cellRow[slot] = i;
+                cellEntity[slot] = a.entities[i];
+                slotCellX[slot] = worldToCell(a.pos.x(i));
+                slotCellY[slot] = worldToCell(a.pos.y(i));
+            }
+        });
+
+        maxCellRadius = 0.0f;
+        for (int slot = 0; slot < gridCount; slot++) maxCellRadius = std::max(maxCellRadius, cellRadius[slot]);
+
+        // Serial: scrierile sunt imprastiate, in paralel ar imparti linii de cache
+        flatSlot.resize(count);
+        for (int slot = 0; slot < count; slot++) flatSlot[sortRefs[slot]] = slot < gridCount ? slot : -1;
+        return gridCount;
+    }
+
+    // 3. COIN SEPARATION PHYSICS
+    // Fiecare moneda aduna impingerile din 3x3 celule (ca monedele de pe granita
+    // sa se separe si ele), in ordine fixa, si scrie doar in propriul slot.
+    // Monedele adormite imping ca obstacole fixe si ajung in wakeList; cele treze
+    // linistite SLEEP_STEPS pasi ajung in sleepList (aplicate in updateSleep).
+    void separateCoins(int gridCount, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/separation");
+        int grain = grainFor(gridCount, jobs);
+        wakeList.clear();
+        sleepList.clear();
+        jobs.parallelFor(0, gridCount, grain, CACHE_LINE_ROWS, [&](int start, int end) {
+            std::vector<Entity> woken;
+            for (int a = start; a < end; a++) {
+                float sumX = 0.0f, sumY = 0.0f;
+
+                if (cellType[a] == TYPE_COIN) {
+                    for (int y = slotCellY[a] - 1; y <= slotCellY[a] + 1; y++) {
+                        for (int x = slotCellX[a] - 1; x <= slotCellX[a] + 1; x++) {
+                            forEachInCell(x, y, [&](int b) {
+                                if (b != a) accumulatePush(a, b, sumX, sumY);
+                            });
+                        }
+                    }
+
+                    for (int y = slotCellY[a] - 1; y <= slotCellY[a] + 1 && sleepers.size() > 0; y++) {
+                        for (int x = slotCellX[a] - 1; x <= slotCellX[a] + 1; x++) {
+                            sleepers.forEachInCell(x, y, [&](const SleepGrid::Node& s) {
+                                if (s.type == TYPE_COIN && separationPush(cellX[a] - s.x, cellY[a] - s.y,
+                                    cellRadius[a] + s.radius, sumX, sumY)) woken.push_back(s.entity);
+                            });
+                        }
+                    }
+                }
+
+                pushX[a] = sumX;
+                pushY[a] = sumY;
+            }
+
+            if (!woken.empty()) {
+                std::lock_guard<std::mutex> guard(sleepLock);
+                wakeList.insert(wakeList.end(), woken.begin(), woken.end());
+            }
+        });
+
+        // Aplicam deplasarile si scriem inapoi pozitiile monedelor, in ordinea randurilor
+        // din fiecare tabel: bucatile aliniate la CACHE_LINE_ROWS nu impart linii de cache
+        // in pos/rest (citirile din sloturi sunt imprastiate, dar doar citiri)
+        for (int t = 0; t < (int)tables.size(); t++) {
+            Archetype& a = *tables[t];
+            const int* slots = &flatSlot[tableFlatStart[t]];
+            jobs.parallelFor(0, a.count, grainFor(a.count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                std::vector<Entity> tired;
+                for (int row = start; row < end; row++) {
+                    int slot = slots[row];
+                    if (slot < 0 || cellType[slot] != TYPE_COIN) continue;
+                    cellX[slot] += pushX[slot];
+                    cellY[slot] += pushY[slot];
+                    a.pos.x(row) = cellX[slot];
+                    a.pos.y(row) = cellY[slot];
+
+                    if (a.has(COMP_REST)) {
+                        bool quiet = pushX[slot] * pushX[slot] + pushY[slot] * pushY[slot] < SLEEP_PUSH * SLEEP_PUSH;
+                        a.rest[row] = quiet ? a.rest[row] + 1 : 0;
+                        if (a.rest[row] >= SLEEP_STEPS) tired.push_back(cellEntity[slot]);
+                    }
+                }
+
+                if (!tired.empty()) {
+                    std::lock_guard<std::mutex> guard(sleepLock);
+                    sleepList.insert(sleepList.end(), tired.begin(), tired.end());
+                }
+            });
+        }
+
+        // Ordinea din liste depinde de thread-uri: o fixam
+        std::sort(wakeList.begin(), wakeList.end());
+        wakeList.erase(std::unique(wakeList.begin(), wakeList.end()), wakeList.end());
+        std::sort(sleepList.begin(), sleepList.end());
+    }
+
+    // 4. CHECK PLAYER COLLISION - un lot cu o singura interogare (cerc = collider-ul jucatorului)
+    void queryPlayer(Registry& reg, Entity player, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/player query");
+        if (!reg.has<ColliderComponent>(player)) return;
+        pendingDestroy.clear();
+
+        TransformComponent playerPos = reg.get<TransformComponent>(player);
+        playerQuery.clear();
+        playerQuery.addRadius(playerPos.x, playerPos.y, reg.get<ColliderComponent>(player).radius,
+            typeBit(TYPE_COIN) | typeBit(TYPE_ENEMY), player);
+        runQueries(reg, playerQuery, jobs);
+
+        for (const SpatialHit* hit = playerQuery.begin(0); hit != playerQuery.end(0); hit++) {
+            int row;
+            Archetype* a = reg.locate(hit->entity, row);
+            if (a->colliders[row].type == TYPE_COIN) {
+                score++;
+                // Distrugerea muta randuri dense: o amanam pana dupa scanare
+                pendingDestroy.push_back(hit->entity);
+            }
+            else {
+                gameOver = true;
+                reg.set(player, VelocityComponent{ 0, 0 });
+                SpriteComponent sprite = reg.get<SpriteComponent>(player);
+                sprite.r = 100;
+                reg.set(player, sprite);
+            }
+        }
+
+        for (Entity e : pendingDestroy) {
+            sleepers.remove(e);
+            reg.destroyEntity(e);
+        }
+    }
+
+    // 4b. SOMN - trezirile, apoi adormirile din pasul curent (dupa colectare)
+    void updateSleep(Registry& reg) {
+        PROFILE_ZONE("Gameplay/sleep");
+        for (Entity e : wakeList) {
+            if (!sleepers.remove(e)) continue; // Colectata in pasul asta
+            reg.removeComponent<SleepingComponent>(e);
+            reg.set(e, RestComponent{ 0 });
+        }
+
+        for (Entity e : sleepList) {
+            int row;
+            Archetype* a = reg.locate(e, row);
+            if (!a) continue;
+            // Nu mai trece prin Snapshot/previous: ramane desenata pe loc
+            a->prev.x(row) = a->pos.x(row);
+            a->prev.y(row) = a->pos.y(row);
+            sleepers.insert(e, a->pos.x(row), a->pos.y(row), a->colliders[row].radius, (Uint8)a->colliders[row].type);
+            reg.addComponent(e, SleepingComponent());
+        }
+    }
+
+    // Hash-ul adormitelor e refacut din tabele doar daca nu se potriveste cu ele
+    // (snapshot incarcat, 'Z'); in rest il schimba doar updateSleep / colectarea
+    void syncSleepers(Registry& reg) {
+        ArchetypeView sleeping = reg.view<TransformComponent, ColliderComponent, SleepingComponent>(COMP_INACTIVE);
+        int asleep = 0;
+        for (Archetype* a : sleeping) asleep += a->count;
+        if (asleep == sleepers.size()) return;
+
+        sleepers.clear();
+        for (Archetype* a : sleeping) {
+            for (int row = 0; row < a->count; row++) {
+                sleepers.insert(a->entities[row], a->pos.x(row), a->pos.y(row), a->colliders[row].radius, (Uint8)a->colliders[row].type);
+            }
+        }
+    }
+
+    // Sort-and-sweep nu stie de adormite: le trezim pe toate
+    void wakeAll(Registry& reg) {
+        std::vector<Entity> all;
+        for (Archetype* a : reg.view<SleepingComponent>()) all.insert(all.end(), a->entities.data(), a->entities.data() + a->count);
+        for (Entity e : all) {
+            reg.removeComponent<SleepingComponent>(e);
+            if (reg.has<RestComponent>(e)) reg.set(e, RestComponent{ 0 });
+        }
+        sleepers.clear();
+    }
+
+    // --- SPATIAL QUERIES ---
+    // Fiecare entitate din celula: intai grid-ul pasului, apoi monedele adormite.
+    // fn(x, y, radius, type, entity)
+    template <typename Fn>
+    void forEachItemInCell(int cx, int cy, Fn&& fn) const {
+        forEachInCell(cx, cy, [&](int slot) { fn(cellX[slot], cellY[slot], cellRadius[slot], cellType[slot], cellEntity[slot]); });
+        sleepers.forEachInCell(cx, cy, [&](const SleepGrid::Node& s) { fn(s.x, s.y, s.radius, s.type, s.entity); });
+    }
+
+    static bool acceptItem(const Registry& reg, const SpatialQuery& q, Uint8 type, Entity e) {
+        if (q.typeMask != 0 && (q.typeMask & typeBit((EntityType)type)) == 0) return false;
+        return e != q.ignore && reg.isAlive(e);
+    }
+
+    // Celulele din care un collider poate atinge [minX, maxX] x [minY, maxY] (centrul
+    // entitatii e in celula, collider-ul iese cu cel mult raza maxima)
+    template <typename Fn>
+    void forEachItemNear(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+        float reach = std::max(maxCellRadius, sleepers.maxRadius());
+        int x0 = worldToCell(minX - reach), x1 = worldToCell(maxX + reach);
+        int y0 = worldToCell(minY - reach), y1 = worldToCell(maxY + reach);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) forEachItemInCell(x, y, fn);
+        }
+    }
+
+    void queryRadius(const Registry& reg, const SpatialQuery& q, std::vector<SpatialHit>& out) const {
+        forEachItemNear(q.x - q.radius, q.y - q.radius, q.x + q.radius, q.y + q.radius,
+            [&](float x, float y, float radius, Uint8 type, Entity e) {
+                float dx = q.x - x;
+                float dy = q.y - y;
+                float distSq = dx * dx + dy * dy;
+                float rTotal = q.radius + radius;
+                if (distSq < rTotal * rTotal && acceptItem(reg, q, type, e)) out.push_back({ e, x, y, distSq });
+            });
+    }
+
+    void queryBox(const Registry& reg, const SpatialQuery& q, std::vector<SpatialHit>& out) const {
+        forEachItemNear(q.minX, q.minY, q.maxX, q.maxY, [&](float x, float y, float radius, Uint8 type, Entity e) {
+            // Cel mai apropiat punct din dreptunghi fata de centrul collider-ului
+            float ex = x - std::max(q.minX, std::min(q.maxX, x));
+            float ey = y - std::max(q.minY, std::min(q.maxY, y));
+            if (ex * ex + ey * ey > radius * radius || !acceptItem(reg, q, type, e)) return;
+            float dx = q.x - x;
+            float dy = q.y - y;
+            out.push_back({ e, x, y, dx * dx + dy * dy });
+        });
+    }
+
+    // Inele de celule in jurul centrului: dupa inelul d, orice entitate neverificata e la
+    // cel putin `safe` de centru, deci ne oprim cand al k-lea gasit e mai aproape (sau
+    // cand `safe` trece de raza maxima)
+    void queryNearest(const Registry& reg, const SpatialQuery& q, std::vector<SpatialHit>& out) const {
+        if (q.k <= 0) return;
+        SpatialHit best[SpatialQueryBatch::MAX_NEAREST];
+        int found = 0;
+        float maxSq = q.radius * q.radius;
+        int cx = worldToCell(q.x), cy = worldToCell(q.y);
+        int maxRing = (int)(q.radius / CELL_SIZE) + 1;
+
+        for (int d = 0; d <= maxRing; d++) {
+            for (int y = cy - d; y <= cy + d; y++) {
+                bool edgeRow = y == cy - d || y == cy + d;
+                for (int x = cx - d; x <= cx + d; x += (edgeRow || d == 0) ? 1 : 2 * d) {
+                    forEachItemInCell(x, y, [&](float ix, float iy, float, Uint8 type, Entity e) {
+                        float dx = q.x - ix;
+                        float dy = q.y - iy;
+                        float distSq = dx * dx + dy * dy;
+                        if (distSq >= maxSq || (found == q.k && distSq >= best[found - 1].distSq) || !acceptItem(reg, q, type, e)) return;
+
+                        // Insertie in lista sortata (la egalitate ramane primul gasit)
+                        int i = found < q.k ? found++ : found - 1;
+                        while (i > 0 && best[i - 1].distSq > distSq) {
+                            best[i] = best[i - 1];
+                            i--;
+                        }
+                        best[i] = { e, ix, iy, distSq };
+                    });
+                }
+            }
+
+            float safe = std::min(std::min(q.x - (float)((cx - d) * CELL_SIZE), (float)((cx + d + 1) * CELL_SIZE) - q.x),
+                std::min(q.y - (float)((cy - d) * CELL_SIZE), (float)((cy + d + 1) * CELL_SIZE) - q.y));
+            if (safe * safe >= maxSq || (found == q.k && best[found - 1].distSq <= safe * safe)) break;
+        }
+
+        out.insert(out.end(), best, best + found);
+    }
+
+    // 5. SORT-AND-SWEEP (doar BROADPHASE_SWEEP)
+    // Intervalul pe x al fiecarei entitati acopera tot drumul din pas: [min(prev, pos) - r,
+    // max(prev, pos) + r]. Lista sortata de la pasul trecut e refolosita: intre doi pasi
+    // entitatile se misca putin, deci insertion sort-ul face aproape O(n) mutari. Cheia
+    // (minX, entitate) e o ordine totala: ordinea finala nu depinde de ordinea de intrare
+    // (acelasi rezultat si dupa un snapshot incarcat, fara istoric).
+    static bool sweepLess(const SweepEntry& a, const SweepEntry& b) {
+        return a.minX < b.minX || (a.minX == b.minX && a.entity < b.entity);
+    }
+
+    static float sweepMinXOf(const Archetype& a, int row) {
+        return std::min(a.prev.x(row), a.pos.x(row)) - a.colliders[row].radius;
+    }
+
+    void buildSweep(Registry& reg, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/sweep sort");
+        sweepFrame++;
+
+        // Entitatile de la pasul trecut, in aceeasi ordine (cele distruse / inactive ies)
+        int previous = (int)sweepOrder.size();
+        sweepCandidates.resize(previous);
+        jobs.parallelFor(0, previous, BUILD_BLOCK, [&](int start, int end) {
+            for (int k = start; k < end; k++) {
+                SweepEntry& c = sweepCandidates[k];
+                c.entity = sweepOrder[k];
+                c.table = reg.locate(c.entity, c.row);
+                if (c.table && (!c.table->has(COMP_TRANSFORM | COMP_COLLIDER) || c.table->has(COMP_INACTIVE))) c.table = nullptr;
+                if (c.table) c.minX = sweepMinXOf(*c.table, c.row);
+            }
+        });
+
+        sweepEntries.clear();
+        for (const SweepEntry& c : sweepCandidates) {
+            if (!c.table) continue;
+            uint32_t slot = c.entity & ENTITY_INDEX_MASK;
+            if (slot >= sweepStamp.size()) sweepStamp.resize((size_t)slot + 1, 0);
+            sweepStamp[slot] = sweepFrame;
+            sweepEntries.push_back(c);
+        }
+
+        // Entitatile noi merg la final
+        for (Archetype* a : tables) {
+            for (int row = 0; row < a->count; row++) {
+                uint32_t slot = a->entities[row] & ENTITY_INDEX_MASK;
+                if (slot < sweepStamp.size() && sweepStamp[slot] == sweepFrame) continue;
+                sweepEntries.push_back({ sweepMinXOf(*a, row), a->entities[row], a, row });
+            }
+        }
+
+        // Insertion sort cu buget: dupa un restart / multe entitati noi ar fi O(n^2)
+        int n = (int)sweepEntries.size();
+        long long budget = (long long)n * SWEEP_SHIFT_BUDGET;
+        sweepShifts = 0;
+        sweepFullSort = false;
+        for (int i = 1; i < n && !sweepFullSort; i++) {
+            SweepEntry e = sweepEntries[i];
+            int j = i;
+            while (j > 0 && sweepLess(e, sweepEntries[j - 1])) {
+                sweepEntries[j] = sweepEntries[j - 1];
+                j--;
+                if (++sweepShifts > budget) {
+                    sweepFullSort = true;
+                    break;
+                }
+            }
+            sweepEntries[j] = e;
+        }
+        if (sweepFullSort) std::sort(sweepEntries.begin(), sweepEntries.end(), sweepLess);
+
+        sweepOrder.resize(n);
+        for (AlignedVector<float>* c : { &sweepMinX, &sweepMaxX, &sweepMinY, &sweepMaxY, &sweepX0, &sweepY0, &sweepX1, &sweepY1, &sweepRadius }) {
+            c->resize(n);
+        }
+        sweepType.resize(n);
+
+        jobs.parallelFor(0, n, grainFor(n, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+            for (int k = start; k < end; k++) {
+                const SweepEntry& e = sweepEntries[k];
+                const Archetype& a = *e.table;
+                float r = a.colliders[e.row].radius;
+                sweepOrder[k] = e.entity;
+                sweepX0[k] = a.prev.x(e.row);
+                sweepY0[k] = a.prev.y(e.row);
+                sweepX1[k] = a.pos.x(e.row);
+                sweepY1[k] = a.pos.y(e.row);
+                sweepRadius[k] = r;
+                sweepType[k] = (Uint8)a.colliders[e.row].type;
+                sweepMinX[k] = e.minX;
+                sweepMaxX[k] = std::max(sweepX0[k], sweepX1[k]) + r;
+                sweepMinY[k] = std::min(sweepY0[k], sweepY1[k]) - r;
+                sweepMaxY[k] = std::max(sweepY0[k], sweepY1[k]) + r;
+            }
+        });
+    }
+
+    // Perechile cu intervale suprapuse pe x si y, pe blocuri fixe de pozitii sortate
+    // (ordinea perechilor nu depinde de thread-uri). Raman doar moneda-moneda (separare)
+    // si jucator-moneda / jucator-inamic (contacte); un inamic verifica doar jucatorul.
+    void findSweepPairs(Entity player, JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/sweep pairs");
+        int n = (int)sweepEntries.size();
+        sweepPlayer = -1;
+        for (int k = 0; k < n && sweepPlayer < 0; k++) {
+            if (sweepOrder[k] == player) sweepPlayer = k;
+        }
+
+        int numBlocks = (n + BUILD_BLOCK - 1) / BUILD_BLOCK;
+        blockPairs.resize(numBlocks);
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                std::vector<SweepPair>& out = blockPairs[blk];
+                out.clear();
+                int end = std::min(n, (blk + 1) * BUILD_BLOCK);
+                for (int a = blk * BUILD_BLOCK; a < end; a++) {
+                    bool aCoin = sweepType[a] == TYPE_COIN;
+                    if (!aCoin && a != sweepPlayer) {
+                        int p = sweepPlayer;
+                        if (p > a && sweepMinX[p] <= sweepMaxX[a] && sweepMinY[p] <= sweepMaxY[a] && sweepMinY[a] <= sweepMaxY[p]) {
+                            out.push_back({ a, p });
+                        }
+                        continue;
+                    }
+
+                    for (int b = a + 1; b < n && sweepMinX[b] <= sweepMaxX[a]; b++) {
+                        if (sweepMinY[b] > sweepMaxY[a] || sweepMinY[a] > sweepMaxY[b]) continue;
+                        bool relevant = (aCoin && (sweepType[b] == TYPE_COIN || b == sweepPlayer)) ||
+                            (a == sweepPlayer && (sweepType[b] == TYPE_COIN || sweepType[b] == TYPE_ENEMY));
+                        if (relevant) out.push_back({ a, b });
+                    }
+                }
+            }
+        });
+
+        sweepPairs.clear();
+        for (const std::vector<SweepPair>& block : blockPairs) sweepPairs.insert(sweepPairs.end(), block.begin(), block.end());
+        sweepPairCount = (int)sweepPairs.size();
+    }
+
+    // Contactele jucatorului, cu test continuu pe tot pasul. Monedele colectate se
+    // distrug dupa separare (randurile trebuie sa ramana valide pana atunci).
+    void sweepContacts(Registry& reg, Entity player) {
+        PROFILE_ZONE("Gameplay/sweep contacts");
+        pendingDestroy.clear();
+        if (sweepPlayer < 0) return;
+        int p = sweepPlayer;
+
+        for (const SweepPair& pair : sweepPairs) {
+            if (pair.a != p && pair.b != p) continue;
+            int o = pair.a == p ? pair.b : pair.a;
+            if (!sweptOverlap(sweepX0[p], sweepY0[p], sweepX1[p], sweepY1[p],
+                sweepX0[o], sweepY0[o], sweepX1[o], sweepY1[o], sweepRadius[p] + sweepRadius[o])) continue;
+
+            if (sweepType[o] == TYPE_COIN) {
+                score++;
+                pendingDestroy.push_back(sweepOrder[o]);
+            }
+            else if (sweepType[o] == TYPE_ENEMY) {
+                gameOver = true;
+                reg.set(player, VelocityComponent{ 0, 0 });
+                SpriteComponent sprite = reg.get<SpriteComponent>(player);
+                sprite.r = 100;
+                reg.set(player, sprite);
+            }
+        }
+    }
+
+    // Separarea monedelor din perechile moneda-moneda, cu aceeasi impingere ca la grid.
+    // Fiecare pereche impinge ambele monede (simetric); perechile se parcurg in ordine,
+    // deci sumele nu depind de thread-uri.
+    void separateSweep(JobSystem& jobs) {
+        PROFILE_ZONE("Gameplay/sweep separation");
+        int n = (int)sweepEntries.size();
+        sweepPushX.assign(n, 0.0f);
+        sweepPushY.assign(n, 0.0f);
+
+        for (const SweepPair& pair : sweepPairs) {
+            if (sweepType[pair.a] != TYPE_COIN || sweepType[pair.b] != TYPE_COIN) continue;
+            float fx = 0.0f, fy = 0.0f;
+            separationPush(sweepX1[pair.a] - sweepX1[pair.b], sweepY1[pair.a] - sweepY1[pair.b],
+                sweepRadius[pair.a] + sweepRadius[pair.b], fx, fy);
+            sweepPushX[pair.a] += fx;
+            sweepPushY[pair.a] += fy;
+            sweepPushX[pair.b] -= fx;
+            sweepPushY[pair.b] -= fy;
+        }
+
+        jobs.parallelFor(0, n, grainFor(n, jobs), [&](int start, int end) {
+            for (int k = start; k < end; k++) {
+                if (sweepType[k] != TYPE_COIN) continue;
+                const SweepEntry& e = sweepEntries[k];
+                e.table->pos.x(e.row) = sweepX1[k] + sweepPushX[k];
+                e.table->pos.y(e.row) = sweepY1[k] + sweepPushY[k];
+            }
+        });
+    }
+
+    static int grainFor(int count, JobSystem& jobs) {
+        int grain = std::max(256, count / (jobs.threadCount() * 4));
+        return (grain + CACHE_LINE_ROWS - 1) / CACHE_LINE_ROWS * CACHE_LINE_ROWS;
+    }
+};
+
+// --- STEERING SYSTEM (stol + urmarire) ---
+// Agentii sunt entitatile cu <Transform, Velocity, Steering> (inamicii). Ruleaza dupa
+// Gameplay, pe grid-ul construit de el in acelasi pas: pozitiile din grid sunt exact
+// pozitiile curente (separarea muta doar monedele, queryPlayer distruge doar monede),
+// deci vecinii se citesc din sloturile sortate, fara alt spatial hash.
+//  1. gather: pentru fiecare agent, sumele de vecini (inamici sub STEER_RADIUS din cele
+//     3x3 celule, in ordinea din grid, cel mult STEER_MAX_NEIGHBORS) in coloane plate
+//  2. steer:  kernel-ul SIMD calculeaza viteza noua din sume, tot in coloane plate
+//  3. write:  viteza noua se scrie in tabel dupa ce toti agentii au citit vecinii
+// Fiecare agent depinde doar de starea de la inceputul etapei, deci rezultatul e
+// acelasi pentru orice numar de thread-uri.
+class SteeringSystem {
+private:
+    std::vector<Archetype*> tables;
+    std::vector<int> tableBase; // Primul index plat al fiecarui tabel
+
+    AlignedVector<float> x, y, vx, vy;
+    AlignedVector<float> sepX, sepY, sumVX, sumVY, sumX, sumY, neighbors;
+    AlignedVector<float> outVX, outVY;
+
+public:
+    SteerKernel kernel = steerScalar;
+
+    void init(SimdLevel level) { kernel = selectSteerKernel(level); }
+
+    static SystemAccess access() {
+        SystemAccess a;
+        a.query = ComponentMask<TransformComponent, VelocityComponent, SteeringComponent>::value;
+        a.reads = ComponentMask<TransformComponent, VelocityComponent, ColliderComponent>::value;
+        a.writes = ComponentMask<VelocityComponent>::value;
+        return a;
+    }
+
+    void update(Registry& reg, const GameplaySystem& grid, Entity player, JobSystem& jobs) {
+        PROFILE_ZONE("Steering");
+        reg.view<TransformComponent, VelocityComponent, SteeringComponent>().copyTo(tables);
+        tableBase.resize(tables.size());
+        int count = 0;
+        for (size_t t = 0; t < tables.size(); t++) {
+            tableBase[t] = count;
+            count += tables[t]->count;
+        }
+        if (count == 0) return;
+
+        for (AlignedVector<float>* c : { &x, &y, &vx, &vy, &sepX, &sepY, &sumVX, &sumVY, &sumX, &sumY, &neighbors, &outVX, &outVY }) {
+            c->resize(count);
+        }
+
+        // Fara jucator (sau fara pozitie) tinta e departe: doar stol
+        float targetX = 1e30f, targetY = 1e30f;
+        if (reg.has<TransformComponent>(player)) {
+            TransformComponent p = reg.get<TransformComponent>(player);
+            targetX = p.x;
+            targetY = p.y;
+        }
+
+        {
+            PROFILE_ZONE("Steering/gather");
+            for (size_t t = 0; t < tables.size(); t++) {
+                const Archetype& a = *tables[t];
+                int base = tableBase[t];
+                jobs.parallelFor(0, a.count, grainFor(a.count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                    gather(grid, a, base, start, end);
+                });
+            }
+        }
+
+        {
+            PROFILE_ZONE("Steering/steer");
+            jobs.parallelFor(0, count, grainFor(count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                SteerParams p = { x.data(), y.data(), vx.data(), vy.data(), sepX.data(), sepY.data(),
+                    sumVX.data(), sumVY.data(), sumX.data(), sumY.data(), neighbors.data(),
+                    outVX.data(), outVY.data(), targetX, targetY, SIM_DT, start, end };
+                kernel(p);
+            });
+
+            for (size_t t = 0; t < tables.size(); t++) {
+                Archetype& a = *tables[t];
+                int base = tableBase[t];
+                jobs.parallelFor(0, a.count, grainFor(a.count, jobs), CACHE_LINE_ROWS, [&](int start, int end) {
+                    for (int i = start; i < end; i++) {
+                        a.vel.x(i) = outVX[base + i];
+                        a.vel.y(i) = outVY[base + i];
+                    }
+                });
+            }
+        }
+    }
+
+private:
+    static int grainFor(int count, JobSystem& jobs) {
+        int grain = std::max(256, count / (jobs.threadCount() * 4));
+        return (grain + CACHE_LINE_ROWS - 1) / CACHE_LINE_ROWS * CACHE_LINE_ROWS;
+    }
+
+    // Vecinii unui agent: inamicii din grid (orice tabel cu Velocity), fara el insusi.
+    // Fiecare bucata scrie doar indexii plati ai randurilor ei
+    void gather(const GameplaySystem& grid, const Archetype& a, int base, int start, int end) {
+        const float radiusSq = STEER_RADIUS * STEER_RADIUS;
+
+        for (int i = start; i < end; i++) {
+            float px = a.pos.x(i);
+            float py = a.pos.y(i);
+            float sx = 0.0f, sy = 0.0f, svx = 0.0f, svy = 0.0f, spx = 0.0f, spy = 0.0f;
+            int n = 0;
+
+            int cx = worldToCell(px);
+            int cy = worldToCell(py);
+            for (int gy = cy - 1; gy <= cy + 1 && n < STEER_MAX_NEIGHBORS; gy++) {
+                for (int gx = cx - 1; gx <= cx + 1 && n < STEER_MAX_NEIGHBORS; gx++) {
+                    grid.forEachInCell(gx, gy, [&](int slot) {
+                        if (n >= STEER_MAX_NEIGHBORS || grid.cellType[slot] != TYPE_ENEMY) return;
+                        const Archetype& other = *grid.tables[grid.cellTable[slot]];
+                        int row = grid.cellRow[slot];
+                        if ((&other == &a && row == i) || !other.has(COMP_VELOCITY)) return;
+
+                        float dx = px - grid.cellX[slot];
+                        float dy = py - grid.cellY[slot];
+                        float distSq = dx * dx + dy * dy;
+                        if (distSq >= radiusSq || distSq <= 0.0001f) return;
+
+                        sx += dx / distSq;
+                        sy += dy / distSq;
+                        svx += other.vel.x(row);
+                        svy += other.vel.y(row);
+                        spx += grid.cellX[slot];
+                        spy += grid.cellY[slot];
+                        n++;
+                    });
+                }
+            }
+
+            int k = base + i;
+            x[k] = px;
+            y[k] = py;
+            vx[k] = a.vel.x(i);
+            vy[k] = a.vel.y(i);
+            sepX[k] = sx;
+            sepY[k] = sy;
+            sumVX[k] = svx;
+            sumVY[k] = svy;
+            sumX[k] = spx;
+            sumY[k] = spy;
+            neighbors[k] = (float)n;
+        }
+    }
+};
+
+
+// --- SNAPSHOT SYSTEM ---
+// Pe thread-ul de simulare: retine pozitiile de la inceputul pasului si, dupa pas,
+// copiaza starea vizibila intr-un RenderSnapshot.
+class SnapshotSystem {
+private:
+    std::vector<Archetype*> tables;
+    std::vector<int> tableBase;
+
+public:
+    static SystemAccess previousAccess() {
+        SystemAccess a;
+        a.query = ComponentMask<TransformComponent>::value;
+        a.reads = ComponentMask<TransformComponent>::value;
+        a.writes = ACCESS_PREVIOUS;
+        return a;
+    }
+
+    // Inainte de pas: prev = pozitia curenta (la adormite e deja, nu se misca)
+    void storePrevious(Registry& reg) {
+        PROFILE_ZONE("Snapshot/previous");
+        for (Archetype* a : reg.view<TransformComponent>(COMP_SLEEPING)) {
+            // Acelasi layout: se copiaza blocurile intregi
+            for (int b = 0; b < TransformStorage::BLOCKS; b++) {
+                memcpy(a->prev.block(b), a->pos.block(b), sizeof(float) * TransformStorage::blockFloats(a->count));
+            }
+        }
+    }
+
+    void build(const Registry& reg, const GameplaySystem& gameplaySys, Entity player, RenderSnapshot& out, JobSystem& jobs) {
+        PROFILE_ZONE("Snapshot");
+
+        reg.view<TransformComponent, SpriteComponent>(COMP_HIDDEN).copyTo(tables);
+        tableBase.resize(tables.size());
+        int total = 0;
+        for (size_t t = 0; t < tables.size(); t++) {
+            tableBase[t] = total;
+            total += tables[t]->count;
+        }
+        out.sprites.resize(total);
+
+        // Fiecare rand are locul lui fix in snapshot
+        for (size_t t = 0; t < tables.size(); t++) {
+            const Archetype& a = *tables[t];
+            SnapshotSprite* dst = &out.sprites[tableBase[t]];
+            int grain = std::max(1024, a.count / (jobs.threadCount() * 4));
+
+            jobs.parallelFor(0, a.count, grain, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    const SpriteComponent& sprite = a.sprites[i];
+                    SnapshotSprite& s = dst[i];
+                    s.x = a.pos.x(i);
+                    s.y = a.pos.y(i);
+                    s.prevX = a.prev.x(i);
+                    s.prevY = a.prev.y(i);
+                    s.w = sprite.w;
+                    s.h = sprite.h;
+                    s.r = sprite.r;
+                    s.g = sprite.g;
+                    s.b = sprite.b;
+                }
+            });
+        }
+
+        gameplaySys.exportHeatmap(out.heatCells);
+
+        int row;
+        const Archetype* pa = reg.locate(player, row);
+        if (pa) {
+            out.playerX = pa->pos.x(row);
+            out.playerY = pa->pos.y(row);
+            out.playerPrevX = pa->prev.x(row);
+            out.playerPrevY = pa->prev.y(row);
+        }
+        out.score = gameplaySys.score;
+        out.gameOver = gameplaySys.gameOver;
+        out.entityCount = reg.entityCount();
+    }
+};
+
+// --- CAMERA ---
+// Coltul stanga-sus al ferestrei in coordonate de lume (intregi, ca sprite-urile sa
+// nu tremure la scroll). Simularea nu stie de ea; doar RenderSystem o foloseste.
+struct Camera {
+    int x = 0, y = 0;
+
+    // Centrata pe (cx, cy), fara sa iasa din lume
+    void follow(float cx, float cy, float worldWidth, float worldHeight) {
+        x = (int)std::max(0.0f, std::min(cx - WINDOW_WIDTH / 2, worldWidth - WINDOW_WIDTH));
+        y = (int)std::max(0.0f, std::min(cy - WINDOW_HEIGHT / 2, worldHeight - WINDOW_HEIGHT));
+    }
+
+    bool isVisible(int wx, int wy, int w, int h) const {
+        return wx + w > x && wx < x + WINDOW_WIDTH && wy + h > y && wy < y + WINDOW_HEIGHT;
+    }
+};
+
+// --- RENDER SYSTEM CU VISUALIZARE GRID (HEATMAP) ---
+// Deseneaza un RenderSnapshot, nu Registry-ul: pozitiile sunt interpolate intre
+// inceputul si sfarsitul ultimului pas de simulare (alpha in [0, 1]).
+// Doua cai, comutate cu 'B':
+//  - batched (implicit): heatmap-ul si entitatile devin quad-uri colorate intr-un
+//    buffer de varfuri, trimis cu cate un singur SDL_RenderGeometry (SDL >= 2.0.18).
+//    Buffer-ul entitatilor se construieste pe JobSystem in doua treceri pe blocuri
+//    fixe (numara entitatile vizibile, apoi scrie la offset-ul blocului), deci nu e
+//    nevoie de sincronizare si ordinea de desenare ramane cea din snapshot.
+//  - immediate: un SDL_SetRenderDrawColor + SDL_RenderFillRect per dreptunghi
+//    (calea veche, pastrata pt comparatie)
+// Se deseneaza doar ce intra in camera.
+class RenderSystem {
+private:
+    static const int RENDER_BLOCK = 4096;
+
+    struct RenderBlock {
+        int start, end;    // Interval in snapshot.sprites
+        int quadStart;     // Primul quad al blocului in entityVertices
+    };
+
+    std::vector<SDL_Vertex> heatVertices;
+    std::vector<SDL_Vertex> entityVertices;
+    std::vector<int> quadIndices; // 6 indici per quad, acelasi model pentru ambele buffere
+    std::vector<RenderBlock> blocks;
+
+    // Gradient Verde (putine) -> Rosu (multe), transparenta dinamica
+    static SDL_Color heatColor(int count) {
+        SDL_Color c;
+        c.r = (count > 10) ? 255 : 0;
+        c.g = (count < 10) ? 255 : 0;
+        c.b = 0;
+        c.a = (Uint8)std::min(150, count * 20 + 20);
+        return c;
+    }
+
+    static void writeQuad(SDL_Vertex* v, float x, float y, float w, float h, SDL_Color c) {
+        v[0].position = { x, y };
+        v[1].position = { x + w, y };
+        v[2].position = { x + w, y + h };
+        v[3].position = { x, y + h };
+        for (int k = 0; k < 4; k++) {
+            v[k].color = c;
+            v[k].tex_coord = { 0.0f, 0.0f };
+        }
+    }
+
+    // Pozitia interpolata, in pixeli de lume
+    static void interpolate(const SnapshotSprite& s, float alpha, int& x, int& y) {
+        x = (int)(s.prevX + (s.x - s.prevX) * alpha);
+        y = (int)(s.prevY + (s.y - s.prevY) * alpha);
+    }
+
+    static bool isDrawn(const SnapshotSprite& s, int x, int y, const Camera& camera) {
+        return s.w > 0 && camera.isVisible(x, y, s.w, s.h);
+    }
+
+    void ensureQuadIndices(int quads) {
+        int have = (int)quadIndices.size() / 6;
+        if (have >= quads) return;
+        quadIndices.resize((size_t)quads * 6);
+        for (int q = have; q < quads; q++) {
+            int* idx = &quadIndices[(size_t)q * 6];
+            int base = q * 4;
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+        }
+    }
+
+    // Celulele (in coordonate de lume) acoperite de camera
+    static void visibleCells(const Camera& camera, int& cx0, int& cy0, int& cx1, int& cy1) {
+        cx0 = (int)floorf((float)camera.x / CELL_SIZE);
+        cy0 = (int)floorf((float)camera.y / CELL_SIZE);
+        cx1 = (int)floorf((float)(camera.x + WINDOW_WIDTH) / CELL_SIZE);
+        cy1 = (int)floorf((float)(camera.y + WINDOW_HEIGHT) / CELL_SIZE);
+    }
+
+    static bool isCellVisible(const HeatCell& c, int cx0, int cy0, int cx1, int cy1) {
+        return c.cx >= cx0 && c.cx <= cx1 && c.cy >= cy0 && c.cy <= cy1;
+    }
+
+    void drawHeatmapImmediate(SDL_Renderer* renderer, const RenderSnapshot& snap, const Camera& camera) {
+        int cx0, cy0, cx1, cy1;
+        visibleCells(camera, cx0, cy0, cx1, cy1);
+        for (const HeatCell& cell : snap.heatCells) {
+            if (!isCellVisible(cell, cx0, cy0, cx1, cy1)) continue;
+            SDL_Color c = heatColor(cell.count);
+            SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+            SDL_Rect cellRect = { cell.cx * CELL_SIZE - camera.x, cell.cy * CELL_SIZE - camera.y, CELL_SIZE, CELL_SIZE };
+            SDL_RenderFillRect(renderer, &cellRect);
+        }
+    }
+
+    void drawHeatmapBatched(SDL_Renderer* renderer, const RenderSnapshot& snap, const Camera& camera) {
+        int cx0, cy0, cx1, cy1;
+        visibleCells(camera, cx0, cy0, cx1, cy1);
+        heatVertices.clear();
+        for (const HeatCell& cell : snap.heatCells) {
+            if (!isCellVisible(cell, cx0, cy0, cx1, cy1)) continue;
+            heatVertices.resize(heatVertices.size() + 4);
+            writeQuad(&heatVertices[heatVertices.size() - 4],
+                (float)(cell.cx * CELL_SIZE - camera.x), (float)(cell.cy * CELL_SIZE - camera.y),
+                (float)CELL_SIZE, (float)CELL_SIZE, heatColor(cell.count));
+        }
+
+        int quads = (int)heatVertices.size() / 4;
+        if (quads == 0) return;
+        ensureQuadIndices(quads);
+        SDL_RenderGeometry(renderer, nullptr, heatVertices.data(), quads * 4, quadIndices.data(), quads * 6);
+    }
+
+    void drawEntitiesImmediate(const RenderSnapshot& snap, float alpha, SDL_Renderer* renderer, const Camera& camera) {
+        SDL_Rect rect;
+        for (const SnapshotSprite& s : snap.sprites) {
+            int x, y;
+            interpolate(s, alpha, x, y);
+            if (!isDrawn(s, x, y, camera)) continue;
+
+            SDL_SetRenderDrawColor(renderer, s.r, s.g, s.b, 255);
+            rect.x = x - camera.x;
+            rect.y = y - camera.y;
+            rect.w = s.w;
+            rect.h = s.h;
+            SDL_RenderFillRect(renderer, &rect);
+        }
+    }
+
+    void drawEntitiesBatched(const RenderSnapshot& snap, float alpha, SDL_Renderer* renderer, const Camera& camera, JobSystem& jobs) {
+        int count = (int)snap.sprites.size();
+        blocks.clear();
+        for (int start = 0; start < count; start += RENDER_BLOCK) {
+            RenderBlock b = { start, std::min(count, start + RENDER_BLOCK), 0 };
+            blocks.push_back(b);
+        }
+        int numBlocks = (int)blocks.size();
+
+        // 1. Cate entitati vizibile are fiecare bloc
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                RenderBlock& b = blocks[blk];
+                int n = 0;
+                for (int i = b.start; i < b.end; i++) {
+                    int x, y;
+                    interpolate(snap.sprites[i], alpha, x, y);
+                    n += isDrawn(snap.sprites[i], x, y, camera) ? 1 : 0;
+                }
+                b.quadStart = n;
+            }
+        });
+
+        int quads = 0;
+        for (RenderBlock& b : blocks) {
+            int n = b.quadStart;
+            b.quadStart = quads;
+            quads += n;
+        }
+        if (quads == 0) return;
+
+        entityVertices.resize((size_t)quads * 4);
+        ensureQuadIndices(quads);
+
+        // 2. Fiecare bloc isi scrie quad-urile de la offset-ul lui
+        jobs.parallelFor(0, numBlocks, 1, [&](int firstBlock, int lastBlock) {
+            for (int blk = firstBlock; blk < lastBlock; blk++) {
+                const RenderBlock& b = blocks[blk];
+                SDL_Vertex* out = &entityVertices[(size_t)b.quadStart * 4];
+
+                for (int i = b.start; i < b.end; i++) {
+                    const SnapshotSprite& s = snap.sprites[i];
+                    int x, y;
+                    interpolate(s, alpha, x, y);
+                    if (!isDrawn(s, x, y, camera)) continue;
+                    // Coordonate rotunjite ca la SDL_Rect, ca cele doua cai sa arate identic
+                    SDL_Color c = { s.r, s.g, s.b, 255 };
+                    writeQuad(out, (float)(x - camera.x), (float)(y - camera.y), (float)s.w, (float)s.h, c);
+                    out += 4;
+                }
+            }
+        });
+
+        SDL_RenderGeometry(renderer, nullptr, entityVertices.data(), quads * 4, quadIndices.data(), quads * 6);
+    }
+
+public:
+    bool batched = true;
+
+    // Deseneaza scena; SDL_RenderPresent il face apelantul (dupa overlay)
+    void render(const RenderSnapshot& snap, float alpha, SDL_Renderer* renderer, const Camera& camera, JobSystem& jobs) {
+        SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
+        SDL_RenderClear(renderer);
+
+        // --- DRAW GRID HEATMAP ---
+        {
+            PROFILE_ZONE("Render/heatmap");
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); // Transparenta
+
+            if (batched) drawHeatmapBatched(renderer, snap, camera);
+            else drawHeatmapImmediate(renderer, snap, camera);
+
+            // Linii grid (doar cele din camera)
+            int cx0, cy0, cx1, cy1;
+            visibleCells(camera, cx0, cy0, cx1, cy1);
+            SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
+            for (int x = cx0; x <= cx1 + 1; x++) SDL_RenderDrawLine(renderer, x * CELL_SIZE - camera.x, 0, x * CELL_SIZE - camera.x, WINDOW_HEIGHT);
+            for (int y = cy0; y <= cy1 + 1; y++) SDL_RenderDrawLine(renderer, 0, y * CELL_SIZE - camera.y, WINDOW_WIDTH, y * CELL_SIZE - camera.y);
+
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        }
+        // ------------------------
+
+        PROFILE_ZONE("Render/entities");
+        if (batched) drawEntitiesBatched(snap, alpha, renderer, camera, jobs);
+        else drawEntitiesImmediate(snap, alpha, renderer, camera);
+    }
+};
+
+// --- DEBUG OVERLAY (PROFILER) ---
+// Tabel min / avg / p99 (ms pe frame) pentru fiecare zona, scris cu un font bitmap de
+// 3x5 pixeli (fara SDL_ttf). Toate dreptunghiurile textului merg intr-un singur
+// SDL_RenderFillRects.
+class DebugOverlay {
+private:
+    static const int PIXEL = 2;                 // Marimea unui pixel de font pe ecran
+    static const int GLYPH_W = 3, GLYPH_H = 5;
+    static const int ADVANCE = (GLYPH_W + 1) * PIXEL;
+    static const int LINE_HEIGHT = (GLYPH_H + 2) * PIXEL;
+
+    std::vector<SDL_Rect> rects;
 
-float randomFloat(float min, float max) {
-    return min + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (max - min)));
-}
+    // 5 randuri x 3 coloane, de sus in jos ('1' = pixel aprins)
+    static const char* glyph(char c) {
+        switch (c) {
+        case '0': return "111101101101111"; case '1': return "010110010010111";
+        case '2': return "111001111100111"; case '3': return "111001111001111";
+        case '4': return "101101111001001"; case '5': return "111100111001111";
+        case '6': return "111100111101111"; case '7': return "111001001001001";
+        case '8': return "111101111101111"; case '9': return "111101111001111";
+        case 'A': return "010101111101101"; case 'B': return "110101110101110";
+        case 'C': return "011100100100011"; case 'D': return "110101101101110";
+        case 'E': return "111100110100111"; case 'F': return "111100110100100";
+        case 'G': return "011100101101011"; case 'H': return "101101111101101";
+        case 'I': return "111010010010111"; case 'J': return "001001001101010";
+        case 'K': return "101101110101101"; case 'L': return "100100100100111";
+        case 'M': return "101111111101101"; case 'N': return "110101101101101";
+        case 'O': return "010101101101010"; case 'P': return "110101110100100";
+        case 'Q': return "010101101110011"; case 'R': return "110101110101101";
+        case 'S': return "011100010001110"; case 'T': return "111010010010010";
+        case 'U': return "101101101101111"; case 'V': return "101101101101010";
+        case 'W': return "101101111111101"; case 'X': return "101101010101101";
+        case 'Y': return "101101010010010"; case 'Z': return "111001010100111";
+        case '.': return "000000000000010"; case ':': return "000010000010000";
+        case '/': return "001001010100100"; case '-': return "000000111000000";
+        case '%': return "101001010100101"; case '(': return "010100100100010";
+        case ')': return "010001001001010"; case '_': return "000000000000111";
+        default: return nullptr;
+        }
+    }
 
-// ==========================================
-// 1. COMPONENTE
-// ==========================================
-struct TransformComponent { float x, y; };
-struct VelocityComponent { float vx, vy; };
-struct SpriteComponent { bool isVisible; Uint8 r, g, b; int w, h; };
-enum EntityType { TYPE_NONE, TYPE_PLAYER, TYPE_ENEMY, TYPE_COIN };
-struct ColliderComponent { bool isActive; float radius; EntityType type; };
+    void addText(int x, int y, const char* text) {
+        for (; *text; text++, x += ADVANCE) {
+            const char* bits = glyph((char)toupper((unsigned char)*text));
+            if (!bits) continue;
+            for (int row = 0; row < GLYPH_H; row++) {
+                for (int col = 0; col < GLYPH_W; col++) {
+                    if (bits[row * GLYPH_W + col] == '1') {
+                        rects.push_back({ x + col * PIXEL, y + row * PIXEL, PIXEL, PIXEL });
+                    }
+                }
+            }
+        }
+    }
 
-// ==========================================
-// 2. REGISTRY
-// ==========================================
-class Registry {
 public:
-    std::vector<TransformComponent> transforms;
-    std::vector<VelocityComponent> velocities;
-    std::vector<SpriteComponent> sprites;
-    std::vector<ColliderComponent> colliders;
+    bool visible = true;
 
-    // Lista inlantuita intrusiva (Next Pointer)
-    std::vector<int> nextEntity;
+    void render(SDL_Renderer* renderer, const Profiler& profiler, int threads, int entities) {
+        if (!visible) return;
+        PROFILE_ZONE("Render/overlay");
 
-    int entityCount = 0;
+        const std::vector<Profiler::ZoneStats>& zones = profiler.stats();
+        const int x0 = 10, y0 = 10;
+        rects.clear();
 
-    void init(int maxEntities) {
-        transforms.resize(maxEntities);
-        velocities.resize(maxEntities);
-        sprites.resize(maxEntities);
-        colliders.resize(maxEntities);
-        nextEntity.resize(maxEntities);
-        entityCount = 0;
-    }
+        char line[128];
+        int y = y0;
+        snprintf(line, sizeof(line), "THREADS: %d  ENTITIES: %d%s", threads, entities, profiler.isCapturing() ? "  TRACE..." : "");
+        addText(x0, y, line);
+        y += LINE_HEIGHT;
+        snprintf(line, sizeof(line), "%-24s %7s %7s %7s", "ZONE (MS/FRAME)", "MIN", "AVG", "P99");
+        addText(x0, y, line);
+        y += LINE_HEIGHT;
+        for (const Profiler::ZoneStats& z : zones) {
+            snprintf(line, sizeof(line), "%-24s %7.3f %7.3f %7.3f", z.name, z.minMs, z.avgMs, z.p99Ms);
+            addText(x0, y, line);
+            y += LINE_HEIGHT;
+        }
 
-    int createEntity() {
-        if (entityCount >= transforms.size()) return -1;
-        int id = entityCount++;
-        colliders[id].isActive = false;
-        sprites[id].isVisible = true;
-        velocities[id] = { 0, 0 };
-        nextEntity[id] = -1;
-        return id;
-    }
+        // Fundal semi-transparent, apoi textul
+        SDL_Rect panel = { x0 - 6, y0 - 6, 52 * ADVANCE + 12, y - y0 + 12 };
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+        SDL_RenderFillRect(renderer, &panel);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
-    void destroyEntity(int id) {
-        sprites[id].isVisible = false;
-        colliders[id].isActive = false;
-        transforms[id].x = -10000;
+        SDL_SetRenderDrawColor(renderer, 230, 230, 230, 255);
+        if (!rects.empty()) SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
     }
 };
 
 // ==========================================
-// 3. SISTEME
+// 7. SNAPSHOT BINAR (STARE + REPLAY)
 // ==========================================
+// Starea completa a simularii intr-un fisier: toate coloanele Registry-ului, tabelele
+// de slot-uri, scorul / game over, seed-ul si frame-ul fizicii, plus inputul fiecarui
+// pas inregistrat si hash-ul starii dupa el. Hash-ul spatial se reconstruieste in
+// fiecare pas, deci nu intra in fisier.
+//
+// Coloanele sunt aliniate la 64 de bytes in fisier, iar la incarcare fisierul e mapat
+// (copy-on-write) si coloanele il folosesc direct, fara copiere: o lume de milioane de
+// entitati porneste imediat, paginile se citesc cand sunt atinse. Tabelele de slot-uri
+// sunt mici si se copiaza.
+//
+// Fisierul e legat de layout-ul structurilor din build-ul care l-a scris (marimile lui
+// SpriteComponent / ColliderComponent sunt verificate la incarcare).
+
+// Fisier mapat read-only, cu paginile private: scrierile simularii nu ajung pe disc
+class MappedFile {
+private:
+    char* base = nullptr;
+    size_t length = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
 
-class InputSystem {
 public:
-    void update(Registry& reg, const Uint8* keys, int playerID) {
-        float speed = 350.0f;
-        reg.velocities[playerID].vx = 0;
-        reg.velocities[playerID].vy = 0;
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-        if (keys[SDL_SCANCODE_W] || keys[SDL_SCANCODE_UP])    reg.velocities[playerID].vy = -speed;
-        if (keys[SDL_SCANCODE_S] || keys[SDL_SCANCODE_DOWN])  reg.velocities[playerID].vy = speed;
-        if (keys[SDL_SCANCODE_A] || keys[SDL_SCANCODE_LEFT])  reg.velocities[playerID].vx = -speed;
-        if (keys[SDL_SCANCODE_D] || keys[SDL_SCANCODE_RIGHT]) reg.velocities[playerID].vx = speed;
+    bool open(const char* path) {
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { close(); return false; }
+        mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (!mapping) { close(); return false; }
+        base = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+        if (!base) { close(); return false; }
+        length = (size_t)size.QuadPart;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd); // Maparea ramane valida
+        if (p == MAP_FAILED) return false;
+        base = static_cast<char*>(p);
+        length = (size_t)st.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
     }
+
+    char* data() const { return base; }
+    size_t size() const { return length; }
 };
 
-// --- PHYSICS SYSTEM MULTI-THREADED ---
-class PhysicsSystem {
+// Un pas inregistrat: inputul aplicat si hash-ul starii dupa pas
+struct StepRecord {
+    uint32_t input;    // InputBit
+    uint32_t restart;  // 1 = 'R' a fost cerut inainte de pas
+    uint64_t hash;     // StateFile::hashState
+};
+
+class StateFile {
 public:
-    void processChunk(Registry& reg, float dt, int start, int end) {
-        for (int i = start; i < end; i++) {
-            if (!reg.sprites[i].isVisible) continue;
+    static const uint32_t VERSION = 3;
+    static const int COLUMN_COUNT = 13;
 
-            // Jiggle (Tremurat) - doar la monede
-            if (reg.colliders[i].type == TYPE_COIN) {
-                reg.transforms[i].x += randomFloat(-1.0f, 1.0f);
-                reg.transforms[i].y += randomFloat(-1.0f, 1.0f);
-            }
+    // Ce nu e in Registry
+    struct SimState {
+        uint32_t seed = 0;
+        uint32_t physicsFrame = 0;
+        uint64_t stepCount = 0;
+        int score = 0;
+        bool gameOver = false;
+        Entity player = INVALID_ENTITY;
+        int worldScreens = DEFAULT_WORLD_SCREENS;
+        BroadphaseMode broadphase = BROADPHASE_GRID;
+    };
+
+    // Starea curenta, fara pasi; appendSteps adauga pasii inainte de scriere
+    static void save(const Registry& reg, const SimState& sim, std::vector<char>& out) {
+        out.assign(sizeof(Header), 0);
+
+        Header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, MAGIC, sizeof(h.magic));
+        h.version = VERSION;
+        h.headerSize = sizeof(Header);
+        h.spriteSize = sizeof(SpriteComponent);
+        h.colliderSize = sizeof(ColliderComponent);
+        h.transformLayout = TransformStorage::LAYOUT_ID;
+        h.velocityLayout = VelocityStorage::LAYOUT_ID;
+        h.boundsLayout = BoundsStorage::LAYOUT_ID;
+        h.seed = sim.seed;
+        h.physicsFrame = sim.physicsFrame;
+        h.stepCount = sim.stepCount;
+        h.score = sim.score;
+        h.gameOver = sim.gameOver ? 1 : 0;
+        h.player = sim.player;
+        h.worldScreens = sim.worldScreens;
+        h.broadphase = (uint32_t)sim.broadphase;
+        h.archetypeCount = (uint32_t)reg.archetypes.size();
+        h.slotCount = (uint32_t)reg.generations.size();
+        h.freeSlotCount = (uint32_t)reg.freeSlots.size();
 
-            // Move
-            reg.transforms[i].x += reg.velocities[i].vx * dt;
-            reg.transforms[i].y += reg.velocities[i].vy * dt;
+        // Toate arhetipurile, si cele goale: slotArchetype tine indexul lor
+        h.archetypeOffset = reserve(out, sizeof(ArchetypeRecord) * h.archetypeCount, 8);
+        h.slotOffset = append(out, reg.generations.data(), h.slotCount * sizeof(uint32_t), 64);
+        append(out, reg.slotArchetype.data(), h.slotCount * sizeof(int), 4);
+        append(out, reg.slotRow.data(), h.slotCount * sizeof(int), 4);
+        append(out, reg.freeSlots.data(), h.freeSlotCount * sizeof(uint32_t), 4);
 
-            // Bounce (Pereti)
-            if (reg.velocities[i].vx != 0 || reg.velocities[i].vy != 0) {
-                if (reg.transforms[i].x <= 0 || reg.transforms[i].x >= WINDOW_WIDTH - reg.sprites[i].w) reg.velocities[i].vx *= -1;
-                if (reg.transforms[i].y <= 0 || reg.transforms[i].y >= WINDOW_HEIGHT - reg.sprites[i].h) reg.velocities[i].vy *= -1;
+        for (uint32_t i = 0; i < h.archetypeCount; i++) {
+            const Archetype& a = *reg.archetypes[i];
+            ArchetypeRecord rec;
+            memset(&rec, 0, sizeof(rec));
+            rec.mask = a.mask;
+            rec.count = a.count;
+            size_t n = (size_t)a.count;
+            for (int c = 0; c < COLUMN_COUNT && n > 0; c++) {
+                if (hasColumn(a, c)) rec.columns[c] = append(out, columnData(a, c), columnBytes(c, n), 64);
             }
+            memcpy(&out[h.archetypeOffset + i * sizeof(ArchetypeRecord)], &rec, sizeof(rec));
         }
+
+        h.stepOffset = alignTo(out, 64);
+        h.fileSize = out.size();
+        memcpy(&out[0], &h, sizeof(h));
     }
 
-    void update(Registry& reg, float dt) {
-        unsigned int numThreads = std::thread::hardware_concurrency();
-        if (numThreads == 0) numThreads = 2;
+    static void appendSteps(std::vector<char>& file, const std::vector<StepRecord>& steps) {
+        Header h;
+        memcpy(&h, &file[0], sizeof(h));
+        file.resize((size_t)h.stepOffset);
+        if (!steps.empty()) append(file, steps.data(), steps.size() * sizeof(StepRecord), 8);
+        h.stepRecordCount = (uint32_t)steps.size();
+        h.fileSize = file.size();
+        memcpy(&file[0], &h, sizeof(h));
+    }
 
-        std::vector<std::thread> threads;
-        int count = reg.entityCount;
-        int chunkSize = count / numThreads;
+    static bool write(const char* path, const std::vector<char>& file) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        out.write(file.data(), (std::streamsize)file.size());
+        return (bool)out;
+    }
 
-        for (unsigned int i = 0; i < numThreads; i++) {
-            int start = i * chunkSize;
-            int end = (i == numThreads - 1) ? count : (i + 1) * chunkSize;
-            threads.emplace_back(&PhysicsSystem::processChunk, this, std::ref(reg), dt, start, end);
+    // Registry-ul foloseste memoria lui `file` (care trebuie sa traiasca cat el);
+    // `steps` arata in fisier. Fals (cu mesaj) pt fisier invalid.
+    static bool load(const MappedFile& file, Registry& reg, SimState& sim,
+        const StepRecord*& steps, size_t& stepRecordCount) {
+        const char* base = file.data();
+        size_t size = file.size();
+        Header h;
+        if (!base || size < sizeof(Header)) return fail("fisier prea mic");
+        memcpy(&h, base, sizeof(h));
+        if (memcmp(h.magic, MAGIC, sizeof(h.magic)) != 0) return fail("nu e un snapshot Phase2");
+        if (h.version != VERSION || h.headerSize != sizeof(Header)) return fail("versiune diferita");
+        if (h.spriteSize != sizeof(SpriteComponent) || h.colliderSize != sizeof(ColliderComponent) ||
+            h.transformLayout != TransformStorage::LAYOUT_ID || h.velocityLayout != VelocityStorage::LAYOUT_ID ||
+            h.boundsLayout != BoundsStorage::LAYOUT_ID) {
+            return fail("layout-ul componentelor difera de acest build");
         }
+        if (h.fileSize != size) return fail("fisier trunchiat");
 
-        for (auto& t : threads) t.join();
-    }
-};
+        size_t recordBytes = (size_t)h.archetypeCount * sizeof(ArchetypeRecord);
+        size_t slotBytes = (size_t)h.slotCount * (sizeof(uint32_t) + 2 * sizeof(int)) + (size_t)h.freeSlotCount * sizeof(uint32_t);
+        size_t stepBytes = (size_t)h.stepRecordCount * sizeof(StepRecord);
+        if (!inside(h.archetypeOffset, recordBytes, size) || !inside(h.slotOffset, slotBytes, size) ||
+            !inside(h.stepOffset, stepBytes, size) || h.stepOffset % alignof(StepRecord) != 0) {
+            return fail("offset-uri invalide");
+        }
+        if (h.slotCount > ENTITY_INDEX_MASK || h.freeSlotCount > h.slotCount) return fail("prea multe slot-uri");
+        if (h.worldScreens < 1 || h.worldScreens > MAX_WORLD_SCREENS) return fail("marime de lume invalida");
+        std::vector<std::pair<uint64_t, size_t>> regions = {
+            { 0, sizeof(Header) }, { h.archetypeOffset, recordBytes }, { h.slotOffset, slotBytes }, { h.stepOffset, stepBytes }
+        };
 
-// --- GAMEPLAY SYSTEM (Grid + Coin Physics + Heatmap Data) ---
-class GameplaySystem {
-private:
-    int gridHead[MAX_CELLS];
-    int cellCounts[MAX_CELLS]; // Pentru vizualizare (Heatmap)
+        reg.init(MAX_ENTITIES);
+        const char* slots = base + h.slotOffset;
+        reg.generations.resize(h.slotCount);
+        reg.slotArchetype.resize(h.slotCount);
+        reg.slotRow.resize(h.slotCount);
+        reg.freeSlots.resize(h.freeSlotCount);
+        copyOut(reg.generations.data(), slots, h.slotCount * sizeof(uint32_t));
+        copyOut(reg.slotArchetype.data(), slots, h.slotCount * sizeof(int));
+        copyOut(reg.slotRow.data(), slots, h.slotCount * sizeof(int));
+        copyOut(reg.freeSlots.data(), slots, h.freeSlotCount * sizeof(uint32_t));
 
-public:
-    int score = 0;
-    bool gameOver = false;
+        for (uint32_t i = 0; i < h.archetypeCount; i++) {
+            ArchetypeRecord rec;
+            memcpy(&rec, base + h.archetypeOffset + i * sizeof(ArchetypeRecord), sizeof(rec));
+            if (rec.count < 0 || (rec.mask & ~KNOWN_COMPONENTS) != 0) return fail("arhetip invalid");
+            for (const auto& other : reg.archetypes) {
+                if (other->mask == rec.mask) return fail("arhetip duplicat");
+            }
 
-    // Getter pentru RenderSystem
-    int getCountInCell(int col, int row) const {
-        if (col < 0 || col >= GRID_COLS || row < 0 || row >= GRID_ROWS) return 0;
-        return cellCounts[row * GRID_COLS + col];
-    }
+            std::unique_ptr<Archetype> a(new Archetype());
+            a->mask = rec.mask;
+            a->count = rec.count;
+            a->bindArena(&reg.arena); // Randurile noi (dupa capacitatea mapata) merg in arena
+            size_t n = (size_t)rec.count;
+            for (int c = 0; c < COLUMN_COUNT && n > 0; c++) {
+                if (!hasColumn(*a, c)) continue;
+                if (rec.columns[c] == 0 || rec.columns[c] % 64 != 0 || !inside(rec.columns[c], columnBytes(c, n), size)) {
+                    return fail("coloana invalida");
+                }
+                regions.push_back({ rec.columns[c], columnBytes(c, n) });
+            }
+            if (n > 0) adoptColumns(*a, file.data(), rec.columns, n);
+            reg.archetypes.push_back(std::move(a));
+        }
 
-    void update(Registry& reg, int playerID) {
-        if (gameOver) return;
+        // Coloanele sunt mapate direct si scrise pe loc: doua regiuni suprapuse ar face ca
+        // un sistem sa scrie peste datele altuia
+        regions.erase(std::remove_if(regions.begin(), regions.end(),
+            [](const std::pair<uint64_t, size_t>& r) { return r.second == 0; }), regions.end());
+        std::sort(regions.begin(), regions.end());
+        for (size_t i = 1; i < regions.size(); i++) {
+            if (regions[i].first - regions[i - 1].first < regions[i - 1].second) return fail("regiuni suprapuse");
+        }
+        const char* error = checkSlots(reg);
+        if (error) return fail(error);
+        if (!reg.isAlive(h.player)) return fail("jucatorul nu e o entitate vie");
+        // Jocul scrie direct in componentele jucatorului (viteza, sprite-ul la game over)
+        const uint32_t playerMask = COMP_TRANSFORM | COMP_VELOCITY | COMP_BOUNDS | COMP_SPRITE | COMP_COLLIDER;
+        int playerRow = 0;
+        if ((reg.locate(h.player, playerRow)->mask & playerMask) != playerMask) return fail("jucatorul nu are componentele lui");
 
-        // 1. CLEAR
-        std::fill(std::begin(gridHead), std::end(gridHead), -1);
-        std::fill(std::begin(cellCounts), std::end(cellCounts), 0);
-
-        // 2. POPULATE
-        for (int i = 0; i < reg.entityCount; i++) {
-            if (!reg.colliders[i].isActive) continue;
-            if (i == playerID) continue;
-
-            int cx = (int)(reg.transforms[i].x / CELL_SIZE);
-            int cy = (int)(reg.transforms[i].y / CELL_SIZE);
-
-            if (cx >= 0 && cx < GRID_COLS && cy >= 0 && cy < GRID_ROWS) {
-                int cellIndex = cy * GRID_COLS + cx;
-                reg.nextEntity[i] = gridHead[cellIndex];
-                gridHead[cellIndex] = i;
-
-                cellCounts[cellIndex]++; // Numaram entitatile pt heatmap
-            }
-        }
-
-        // 3. COIN SEPARATION PHYSICS
-        for (int c = 0; c < MAX_CELLS; c++) {
-            int i = gridHead[c];
-            while (i != -1) {
-                int j = reg.nextEntity[i];
-                while (j != -1) {
-                    if (reg.colliders[i].type == TYPE_COIN && reg.colliders[j].type == TYPE_COIN) {
-                        float dx = reg.transforms[i].x - reg.transforms[j].x;
-                        float dy = reg.transforms[i].y - reg.transforms[j].y;
-
-                        if (abs(dx) < 20 && abs(dy) < 20) {
-                            float distSq = dx * dx + dy * dy;
-                            float rTotal = reg.colliders[i].radius + reg.colliders[j].radius;
-
-                            if (distSq < rTotal * rTotal && distSq > 0.0001f) {
-                                float dist = sqrt(distSq);
-                                float overlap = rTotal - dist;
-                                float nx = dx / dist;
-                                float ny = dy / dist;
-                                float separationForce = overlap * 0.5f;
-
-                                reg.transforms[i].x += nx * separationForce;
-                                reg.transforms[i].y += ny * separationForce;
-                                reg.transforms[j].x -= nx * separationForce;
-                                reg.transforms[j].y -= ny * separationForce;
-                            }
-                        }
-                    }
-                    j = reg.nextEntity[j];
+        sim.seed = h.seed;
+        sim.physicsFrame = h.physicsFrame;
+        sim.stepCount = h.stepCount;
+        sim.score = h.score;
+        sim.gameOver = h.gameOver != 0;
+        sim.player = h.player;
+        sim.worldScreens = h.worldScreens;
+        sim.broadphase = h.broadphase == BROADPHASE_SWEEP ? BROADPHASE_SWEEP : BROADPHASE_GRID;
+        steps = reinterpret_cast<const StepRecord*>(base + h.stepOffset);
+        stepRecordCount = h.stepRecordCount;
+        return true;
+    }
+
+    // FNV-1a pe 64 de biti peste randurile folosite din fiecare tabel + scor. Sprite-urile
+    // si collider-ele se iau pe campuri: padding-ul lor nu e determinist.
+    static uint64_t hashState(const Registry& reg, int score, bool gameOver) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        hashBytes(h, &score, sizeof(score));
+        uint8_t over = gameOver ? 1 : 0;
+        hashBytes(h, &over, 1);
+        for (const auto& ap : reg.archetypes) {
+            const Archetype& a = *ap;
+            size_t n = (size_t)a.count;
+            hashBytes(h, &a.mask, sizeof(a.mask));
+            hashBytes(h, &a.count, sizeof(a.count));
+            if (n == 0) continue;
+            if (a.has(COMP_TRANSFORM)) hashVec2(h, a.pos, n);
+            if (a.has(COMP_VELOCITY)) hashVec2(h, a.vel, n);
+            if (a.has(COMP_BOUNDS)) hashVec2(h, a.bound, n);
+            if (a.has(COMP_JIGGLE)) hashBytes(h, a.jiggle.data(), n * 4);
+            if (a.has(COMP_SPRITE)) {
+                for (size_t i = 0; i < n; i++) {
+                    const SpriteComponent& s = a.sprites[i];
+                    uint8_t bytes[3] = { s.r, s.g, s.b };
+                    hashBytes(h, bytes, 3);
+                    hashBytes(h, &s.w, sizeof(s.w));
+                    hashBytes(h, &s.h, sizeof(s.h));
+                }
+            }
+            if (a.has(COMP_COLLIDER)) {
+                for (size_t i = 0; i < n; i++) {
+                    const ColliderComponent& c = a.colliders[i];
+                    int32_t type = (int32_t)c.type;
+                    hashBytes(h, &c.radius, sizeof(c.radius));
+                    hashBytes(h, &type, sizeof(type));
                 }
-                i = reg.nextEntity[i];
             }
+            if (a.has(COMP_REST)) hashBytes(h, a.rest.data(), n * sizeof(uint32_t));
+            hashBytes(h, a.entities.data(), n * sizeof(Entity));
         }
+        return h;
+    }
+
+private:
+    static const char MAGIC[8];
 
-        // 4. CHECK PLAYER COLLISION
-        float px = reg.transforms[playerID].x;
-        float py = reg.transforms[playerID].y;
-        float pr = reg.colliders[playerID].radius;
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t spriteSize, colliderSize; // Layout-ul build-ului care a scris fisierul
+        uint32_t transformLayout, velocityLayout, boundsLayout; // Vec2Storage::LAYOUT_ID
+        uint32_t broadphase;      // BroadphaseMode
+        uint32_t seed;
+        uint32_t physicsFrame;
+        uint64_t stepCount;
+        int32_t score;
+        int32_t gameOver;
+        uint32_t player;
+        int32_t worldScreens;
+        uint32_t archetypeCount;
+        uint32_t slotCount;
+        uint32_t freeSlotCount;
+        uint32_t stepRecordCount;
+        uint64_t archetypeOffset; // ArchetypeRecord[archetypeCount]
+        uint64_t slotOffset;      // generations, slotArchetype, slotRow, freeSlots
+        uint64_t stepOffset;      // StepRecord[stepRecordCount]
+        uint64_t fileSize;
+    };
 
-        int pcx = (int)(px / CELL_SIZE);
-        int pcy = (int)(py / CELL_SIZE);
+    // Offset-ul fiecarei coloane (0 = lipseste), in ordinea din hasColumn
+    struct ArchetypeRecord {
+        uint32_t mask;
+        int32_t count;
+        uint64_t columns[COLUMN_COUNT];
+    };
 
-        for (int x = std::max(0, pcx - 1); x <= std::min(GRID_COLS - 1, pcx + 1); x++) {
-            for (int y = std::max(0, pcy - 1); y <= std::min(GRID_ROWS - 1, pcy + 1); y++) {
-                int cellIndex = y * GRID_COLS + x;
-                int currentEntityID = gridHead[cellIndex];
+    // Coloanele in ordinea din fisier: cate doua sloturi pt pos, prev, vel, bound (al
+    // doilea ramane gol daca layout-ul are un singur bloc), jiggle, sprites, colliders,
+    // entities, rest
+    static bool hasColumn(const Archetype& a, int c) {
+        if (c < 4) return a.has(COMP_TRANSFORM) && c % 2 < TransformStorage::BLOCKS;
+        if (c < 6) return a.has(COMP_VELOCITY) && c % 2 < VelocityStorage::BLOCKS;
+        if (c < 8) return a.has(COMP_BOUNDS) && c % 2 < BoundsStorage::BLOCKS;
+        if (c == 8) return a.has(COMP_JIGGLE);
+        if (c == 9) return a.has(COMP_SPRITE);
+        if (c == 10) return a.has(COMP_COLLIDER);
+        if (c == 12) return a.has(COMP_REST);
+        return true;
+    }
 
-                while (currentEntityID != -1) {
-                    float dx = px - reg.transforms[currentEntityID].x;
-                    float dy = py - reg.transforms[currentEntityID].y;
+    static size_t columnBytes(int c, size_t rows) {
+        if (c < 4) return sizeof(float) * TransformStorage::blockFloats(rows);
+        if (c < 6) return sizeof(float) * VelocityStorage::blockFloats(rows);
+        if (c < 8) return sizeof(float) * BoundsStorage::blockFloats(rows);
+        if (c == 9) return sizeof(SpriteComponent) * rows;
+        if (c == 10) return sizeof(ColliderComponent) * rows;
+        if (c == 11) return sizeof(Entity) * rows;
+        if (c == 12) return sizeof(uint32_t) * rows;
+        return sizeof(float) * rows;
+    }
 
-                    if (abs(dx) < 40 && abs(dy) < 40) {
-                        float distSq = dx * dx + dy * dy;
-                        float rTotal = pr + reg.colliders[currentEntityID].radius;
-
-                        if (distSq < rTotal * rTotal) {
-                            EntityType type = reg.colliders[currentEntityID].type;
-                            if (type == TYPE_COIN) {
-                                score++;
-                                reg.destroyEntity(currentEntityID);
-                            }
-                            else if (type == TYPE_ENEMY) {
-                                gameOver = true;
-                                reg.velocities[playerID] = { 0,0 };
-                                reg.sprites[playerID].r = 100;
-                            }
-                        }
-                    }
-                    currentEntityID = reg.nextEntity[currentEntityID];
-                }
-            }
+    static const void* columnData(const Archetype& a, int c) {
+        const void* list[COLUMN_COUNT] = {
+            a.pos.block(0), a.pos.block(1), a.prev.block(0), a.prev.block(1),
+            a.vel.block(0), a.vel.block(1), a.bound.block(0), a.bound.block(1),
+            a.jiggle.data(), a.sprites.data(), a.colliders.data(), a.entities.data(), a.rest.data()
+        };
+        return list[c];
+    }
+
+    static void adoptColumns(Archetype& a, char* base, const uint64_t* offsets, size_t n) {
+        for (int b = 0; b < 2; b++) {
+            if (offsets[0 + b]) a.pos.adoptBlock(b, reinterpret_cast<float*>(base + offsets[0 + b]), n);
+            if (offsets[2 + b]) a.prev.adoptBlock(b, reinterpret_cast<float*>(base + offsets[2 + b]), n);
+            if (offsets[4 + b]) a.vel.adoptBlock(b, reinterpret_cast<float*>(base + offsets[4 + b]), n);
+            if (offsets[6 + b]) a.bound.adoptBlock(b, reinterpret_cast<float*>(base + offsets[6 + b]), n);
         }
+        if (offsets[8]) a.jiggle.adopt(reinterpret_cast<float*>(base + offsets[8]), n);
+        if (offsets[9]) a.sprites.adopt(reinterpret_cast<SpriteComponent*>(base + offsets[9]), n);
+        if (offsets[10]) a.colliders.adopt(reinterpret_cast<ColliderComponent*>(base + offsets[10]), n);
+        a.entities.adopt(reinterpret_cast<Entity*>(base + offsets[11]), n);
+        if (offsets[12]) a.rest.adopt(reinterpret_cast<uint32_t*>(base + offsets[12]), n);
     }
-};
 
-// --- RENDER SYSTEM CU VISUALIZARE GRID (HEATMAP) ---
-class RenderSystem {
-public:
-    void render(Registry& reg, SDL_Renderer* renderer, const GameplaySystem& gameplaySys) {
-        SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
-        SDL_RenderClear(renderer);
+    // Intai toate x-urile, apoi toate y-urile: acelasi hash la orice layout
+    template <typename S>
+    static void hashVec2(uint64_t& h, const S& v, size_t n) {
+        for (size_t i = 0; i < n; i++) { float x = v.x(i); hashBytes(h, &x, sizeof(x)); }
+        for (size_t i = 0; i < n; i++) { float y = v.y(i); hashBytes(h, &y, sizeof(y)); }
+    }
 
-        // --- DRAW GRID HEATMAP ---
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); // Transparenta
-
-        for (int y = 0; y < GRID_ROWS; y++) {
-            for (int x = 0; x < GRID_COLS; x++) {
-                int count = gameplaySys.getCountInCell(x, y);
-                if (count > 0) {
-                    // Gradient Verde (putine) -> Rosu (multe)
-                    Uint8 r = (count > 10) ? 255 : 0;
-                    Uint8 g = (count < 10) ? 255 : 0;
-                    Uint8 b = 0;
-                    Uint8 a = (Uint8)std::min(150, count * 20 + 20); // Transparenta dinamica
-
-                    SDL_SetRenderDrawColor(renderer, r, g, b, a);
-                    SDL_Rect cellRect = { x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE };
-                    SDL_RenderFillRect(renderer, &cellRect);
-                }
+    static uint64_t alignTo(std::vector<char>& out, size_t alignment) {
+        out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+        return out.size();
+    }
+
+    static uint64_t reserve(std::vector<char>& out, size_t bytes, size_t alignment) {
+        uint64_t offset = alignTo(out, alignment);
+        out.resize(out.size() + bytes, 0);
+        return offset;
+    }
+
+    static uint64_t append(std::vector<char>& out, const void* src, size_t bytes, size_t alignment) {
+        uint64_t offset = reserve(out, bytes, alignment);
+        if (bytes > 0) memcpy(&out[offset], src, bytes);
+        return offset;
+    }
+
+    // Citeste din `src` si avanseaza
+    static void copyOut(void* dst, const char*& src, size_t bytes) {
+        if (bytes > 0) memcpy(dst, src, bytes);
+        src += bytes;
+    }
+
+    static const uint32_t KNOWN_COMPONENTS = COMP_TRANSFORM | COMP_VELOCITY | COMP_BOUNDS | COMP_JIGGLE | COMP_SPRITE |
+        COMP_COLLIDER | COMP_STEERING | COMP_REST | COMP_SLEEPING | COMP_HIDDEN | COMP_INACTIVE;
+
+    // Tabelele de slot-uri si randurile arhetipurilor trebuie sa fie inverse una alteia,
+    // iar free list-ul doar slot-uri moarte, fiecare o data: altfel primul pas ar indexa
+    // in afara tabelelor. Intoarce motivul primei nepotriviri sau null.
+    static const char* checkSlots(const Registry& reg) {
+        size_t slotCount = reg.generations.size();
+        int archetypeCount = (int)reg.archetypes.size();
+        for (size_t i = 0; i < slotCount; i++) {
+            int arch = reg.slotArchetype[i];
+            int row = reg.slotRow[i];
+            if (reg.generations[i] > ENTITY_GENERATION_MASK) return "generatie invalida";
+            if (arch < -1 || arch >= archetypeCount) return "slot cu arhetip invalid";
+            if (arch == -1 ? row != -1 : (row < 0 || row >= reg.archetypes[arch]->count)) return "slot cu rand invalid";
+        }
+        for (int a = 0; a < archetypeCount; a++) {
+            const Archetype& t = *reg.archetypes[a];
+            for (int row = 0; row < t.count; row++) {
+                Entity e = t.entities[row];
+                uint32_t slot = Registry::slotOf(e);
+                if (slot >= slotCount || reg.slotArchetype[slot] != a || reg.slotRow[slot] != row ||
+                    reg.generations[slot] != Registry::generationOf(e)) return "entitate fara slot";
             }
         }
+        std::vector<char> freed(slotCount, 0);
+        for (uint32_t slot : reg.freeSlots) {
+            if (slot >= slotCount || reg.slotArchetype[slot] != -1 || freed[slot]) return "free list invalid";
+            freed[slot] = 1;
+        }
+        return nullptr;
+    }
 
-        // Linii grid
-        SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
-        for (int x = 0; x <= GRID_COLS; x++) SDL_RenderDrawLine(renderer, x * CELL_SIZE, 0, x * CELL_SIZE, WINDOW_HEIGHT);
-        for (int y = 0; y <= GRID_ROWS; y++) SDL_RenderDrawLine(renderer, 0, y * CELL_SIZE, WINDOW_WIDTH, y * CELL_SIZE);
+    static bool inside(uint64_t offset, size_t bytes, size_t fileSize) {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
 
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-        // ------------------------
+    static bool fail(const char* why) {
+        std::cerr << "Snapshot invalid: " << why << std::endl;
+        return false;
+    }
 
-        SDL_Rect rect;
-        for (int i = 0; i < reg.entityCount; i++) {
-            if (!reg.sprites[i].isVisible) continue;
-
-            SDL_SetRenderDrawColor(renderer, reg.sprites[i].r, reg.sprites[i].g, reg.sprites[i].b, 255);
-            rect.x = (int)reg.transforms[i].x;
-            rect.y = (int)reg.transforms[i].y;
-            rect.w = reg.sprites[i].w;
-            rect.h = reg.sprites[i].h;
-            SDL_RenderFillRect(renderer, &rect);
+    static void hashBytes(uint64_t& h, const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
         }
-        SDL_RenderPresent(renderer);
     }
 };
 
+const char StateFile::MAGIC[8] = { 'P', '2', 'S', 'T', 'A', 'T', 'E', 0 };
+
 // ==========================================
-// 4. MAIN ENGINE
+// 8. MAIN ENGINE
 // ==========================================
 class GameEngine {
 private:
@@ -316,94 +4748,793 @@ private:
     InputSystem inputSystem;
     PhysicsSystem physicsSystem;
     RenderSystem renderSystem;
+    DebugOverlay overlay;
     GameplaySystem gameplaySystem;
-    int playerID = 0;
+    SteeringSystem steeringSystem;
+    SnapshotSystem snapshotSystem;
+    SystemScheduler scheduler;   // Etapele unui pas de simulare (buildSchedule)
+    uint32_t stepInput = 0;      // Inputul pasului curent, citit de etapa Input
+    JobSystem jobSystem;
+    SimdLevel simdLevel = SIMD_SCALAR;
+    Entity player = INVALID_ENTITY;
+    Camera camera;
+    int worldScreens = DEFAULT_WORLD_SCREENS;
+    float worldWidth = 0, worldHeight = 0;
+
+    // Simularea ruleaza pe simThread cu pas fix; main-ul doar deseneaza ultimul
+    // snapshot publicat. Singurele date comune sunt atomicii de mai jos si snapshots.
+    // Ambele folosesc workerii jobSystem, dar fiecare cu coada lui externa (simThread e
+    // legat la coada 1): cat asteapta, main ajuta doar la bucatile render-ului si
+    // simThread doar la ale pasului, deci un frame nu ruleaza bucati din simulare.
+    std::thread simThread;
+    std::atomic<bool> simRunning{ false };
+    std::atomic<uint32_t> inputBits{ 0 };       // Scris de main (InputSystem::sample)
+    std::atomic<bool> restartRequested{ false }; // 'R' dupa game over
+    TripleBuffer<RenderSnapshot> snapshots;
+    uint64_t stepCount = 0;
+
+    // Replay: F5 porneste / opreste inregistrarea pe thread-ul de simulare (starea de
+    // la pornire + inputul si hash-ul fiecarui pas), --replay o ruleaza fara fereastra
+    std::atomic<bool> recordToggle{ false };
+    std::atomic<bool> broadphaseToggle{ false }; // 'G', aplicat intre pasi
+    std::atomic<bool> sleepToggle{ false };      // 'Z', aplicat intre pasi
+    bool recording = false;
+    std::vector<char> recordedState;   // StateFile::save la pornirea inregistrarii
+    std::vector<StepRecord> recordedSteps;
+    MappedFile replaySource;           // Coloanele Registry-ului arata aici in --replay
+
+    static const int TRACE_FRAMES = 120; // 'P' salveaza urmatoarele 120 de frame-uri ca Chrome trace
+    static const char* const REPLAY_PATH;
+
+    StateFile::SimState simState() const {
+        StateFile::SimState sim;
+        sim.seed = physicsSystem.seed;
+        sim.physicsFrame = physicsSystem.frame;
+        sim.stepCount = stepCount;
+        sim.score = gameplaySystem.score;
+        sim.gameOver = gameplaySystem.gameOver;
+        sim.player = player;
+        sim.worldScreens = worldScreens;
+        sim.broadphase = gameplaySystem.broadphase;
+        return sim;
+    }
+
+    void setWorldScreens(int screens) {
+        worldScreens = screens;
+        worldWidth = (float)(WINDOW_WIDTH * screens);
+        worldHeight = (float)(WINDOW_HEIGHT * screens);
+    }
+
+    void startRecording() {
+        StateFile::save(registry, simState(), recordedState);
+        recordedSteps.clear();
+        recording = true;
+        std::cout << "Replay: inregistrare pornita la pasul " << stepCount << std::endl;
+    }
+
+    void stopRecording() {
+        recording = false;
+        StateFile::appendSteps(recordedState, recordedSteps);
+        if (StateFile::write(REPLAY_PATH, recordedState)) {
+            std::cout << "Replay: " << recordedSteps.size() << " pasi salvati in " << REPLAY_PATH << std::endl;
+        }
+        else {
+            std::cerr << "Replay: nu pot scrie " << REPLAY_PATH << std::endl;
+        }
+        recordedState.clear();
+        recordedSteps.clear();
+    }
+
+    // Ordinea logica a unui pas; schedulerul ruleaza in paralel ce nu se suprapune
+    // (de ex. Input cu prev, move cu jiggle)
+    void buildSchedule() {
+        scheduler.add("Snapshot/previous", SnapshotSystem::previousAccess(), [this] { snapshotSystem.storePrevious(registry); });
+        scheduler.add("Input", InputSystem::access(), [this] { inputSystem.update(registry, stepInput, player); });
+        scheduler.add("Physics/move", PhysicsSystem::moveAccess(), [this] { physicsSystem.updateMove(registry, SIM_DT, jobSystem); });
+        scheduler.add("Physics/jiggle", PhysicsSystem::jiggleAccess(), [this] { physicsSystem.updateJiggle(registry, jobSystem); });
+        scheduler.add("Gameplay", GameplaySystem::access(), [this] { gameplaySystem.update(registry, player, jobSystem); }); // Grid + Separation pe JobSystem
+        scheduler.add("Steering", SteeringSystem::access(), [this] { steeringSystem.update(registry, gameplaySystem, player, jobSystem); }); // Pe grid-ul de mai sus
+    }
+
+    // Un pas de simulare (thread-ul de simulare). `restart` = 'R' cerut de la pasul trecut
+    void step(uint32_t input, bool restart) {
+        PROFILE_ZONE("Sim step");
+
+        if (restart && gameplaySystem.gameOver) {
+            gameplaySystem.gameOver = false;
+            gameplaySystem.score = 0;
+            SpriteComponent sprite = registry.get<SpriteComponent>(player);
+            sprite.r = 0;
+            registry.set(player, sprite);
+            registry.set(player, VelocityComponent{ 0, 0 });
+        }
+
+        if (gameplaySystem.gameOver) {
+            snapshotSystem.storePrevious(registry);
+        }
+        else {
+            stepInput = input;
+            scheduler.run(registry, jobSystem);
+        }
+        stepCount++;
+
+        if (recording) {
+            StepRecord rec = { input, restart ? 1u : 0u, StateFile::hashState(registry, gameplaySystem.score, gameplaySystem.gameOver) };
+            recordedSteps.push_back(rec);
+        }
+    }
+
+    void publishSnapshot() {
+        RenderSnapshot& snap = snapshots.writeBuffer();
+        snapshotSystem.build(registry, gameplaySystem, player, snap, jobSystem);
+        snap.step = stepCount;
+        snap.recording = recording;
+        snap.broadphase = gameplaySystem.broadphase;
+        snap.sleeping = sleepEnabled() ? gameplaySystem.sleepingCount() : -1;
+        snap.publishTime = SDL_GetPerformanceCounter();
+        snapshots.publish();
+    }
+
+    // Acumulator: timpul real se consuma in pasi de SIM_DT; snapshot-ul se publica
+    // dupa ultimul pas dintr-o serie
+    void simLoop() {
+        Profiler::instance().setThreadName("sim");
+        jobSystem.attachExternal(1);
+        const double freq = (double)SDL_GetPerformanceFrequency();
+        Uint64 last = SDL_GetPerformanceCounter();
+        double accumulator = 0.0;
+
+        while (simRunning.load()) {
+            if (recordToggle.exchange(false)) {
+                if (recording) stopRecording();
+                else startRecording();
+            }
+            if (broadphaseToggle.exchange(false)) {
+                // Replay-ul reface pasii cu broadphase-ul din snapshot-ul de la pornire
+                if (recording) std::cout << "Broadphase: nu se schimba in timpul inregistrarii" << std::endl;
+                else setBroadphase(gameplaySystem.broadphase == BROADPHASE_GRID ? BROADPHASE_SWEEP : BROADPHASE_GRID);
+            }
+            if (sleepToggle.exchange(false)) {
+                if (recording) std::cout << "Somn: nu se schimba in timpul inregistrarii" << std::endl;
+                else setSleep(!sleepEnabled());
+            }
+
+            Uint64 now = SDL_GetPerformanceCounter();
+            accumulator = std::min(accumulator + (double)(now - last) / freq, (double)(SIM_DT * MAX_CATCHUP_STEPS));
+            last = now;
+
+            int steps = 0;
+            while (accumulator >= SIM_DT) {
+                step(inputBits.load(std::memory_order_relaxed), restartRequested.exchange(false));
+                accumulator -= SIM_DT;
+                steps++;
+            }
+
+            if (steps > 0) {
+                publishSnapshot();
+            }
+            else {
+                // Dormim pana aproape de pasul urmator
+                int waitMs = (int)((SIM_DT - accumulator) * 1000.0) - 1;
+                if (waitMs > 0) SDL_Delay((Uint32)waitMs);
+                else std::this_thread::yield();
+            }
+        }
+
+        if (recording) stopRecording();
+    }
 
 public:
-    bool init() {
+    // 0 thread-uri = cate core-uri are masina
+    // Cozi externe: main (render, headless) si thread-ul de simulare
+    explicit GameEngine(unsigned int threads = 0) : jobSystem(threads, 2) { buildSchedule(); }
+
+    void setBroadphase(BroadphaseMode mode) { gameplaySystem.broadphase = mode; }
+
+    // `steps` pasi fara input si fara masurare (dupa game over nivelul continua, ca la
+    // runHeadless); intoarce suma numarului de entitati pe pasi. Folosit de --batch
+    double advance(int steps) {
+        double entityUpdates = 0.0;
+        for (int i = 0; i < steps; i++) {
+            step(0, true);
+            entityUpdates += registry.entityCount();
+        }
+        return entityUpdates;
+    }
+
+    uint64_t stateHash() const { return StateFile::hashState(registry, gameplaySystem.score, gameplaySystem.gameOver); }
+    int entityCount() const { return registry.entityCount(); }
+
+    // Somnul e pornit cand monedele au RestComponent (deci e salvat si in snapshot-uri)
+    bool sleepEnabled() const { return !registry.view<RestComponent>().empty(); }
+
+    void setSleep(bool on) {
+        std::vector<Entity> coins;
+        for (Archetype* a : registry.view<TransformComponent, JiggleComponent>()) {
+            coins.insert(coins.end(), a->entities.data(), a->entities.data() + a->count);
+        }
+        for (Entity e : coins) {
+            if (on) {
+                registry.addComponent(e, RestComponent{ 0 });
+            }
+            else {
+                registry.removeComponent<SleepingComponent>(e);
+                registry.removeComponent<RestComponent>(e);
+            }
+        }
+    }
+
+    bool init(uint32_t seed, SimdLevel simd, int screens, HugePageMode hugePages = HUGEPAGES_TRANSPARENT, int clusters = 0) {
         if (SDL_Init(SDL_INIT_VIDEO) < 0) return false;
         window = SDL_CreateWindow("Phase 2 Final: Multi-Threaded + Smart Grid + Physics", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
         renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
-        registry.init(MAX_ENTITIES);
-        initLevel();
+        int area = screens * screens;
+        initWorld(seed, simd, screens, ENEMIES_PER_SCREEN * area, COINS_PER_SCREEN * area, hugePages, clusters);
         return true;
     }
 
-    void initLevel() {
+    // Doar simularea (Registry + sisteme), fara SDL video: folosit si de --headless
+    // `clusters` > 0: inamicii si monedele stau in atatea grupuri (--clusters), nu uniform
+    void initWorld(uint32_t seed, SimdLevel simd, int screens, int enemies, int coins,
+        HugePageMode hugePages = HUGEPAGES_TRANSPARENT, int clusters = 0) {
+        Profiler::instance().setThreadName("main");
+        physicsSystem.seed = seed;
+        physicsSystem.init(simd);
+        steeringSystem.init(simd);
+        simdLevel = simd;
+        setWorldScreens(screens);
+        // Intervalele arenei: de doua ori nivelul initial, peste asta coloanele trec pe heap
+        ArenaConfig arena;
+        arena.hugePages = hugePages;
+        arena.maxRows = std::max((size_t)1 << 16, (size_t)(1 + enemies + coins) * 2);
+        registry.init(MAX_ENTITIES, arena);
+        initLevel(enemies, coins, clusters);
+    }
+
+    void initLevel(int enemies, int coins, int clusters = 0) {
+        // Centrele grupurilor; entitatea k merge in grupul k % clusters, la o distanta
+        // uniforma pe disc (raza CLUSTER_RADIUS)
+        std::vector<float> centerX, centerY;
+        for (int c = 0; c < clusters; c++) {
+            centerX.push_back(randomFloat(CLUSTER_RADIUS, std::max(CLUSTER_RADIUS, worldWidth - CLUSTER_RADIUS)));
+            centerY.push_back(randomFloat(CLUSTER_RADIUS, std::max(CLUSTER_RADIUS, worldHeight - CLUSTER_RADIUS)));
+        }
+        auto spawn = [&](int k, float margin, float maxX, float maxY) {
+            if (clusters <= 0) return TransformComponent{ randomFloat(margin, maxX), randomFloat(margin, maxY) };
+            float angle = randomFloat(0.0f, 6.2831853f);
+            float dist = CLUSTER_RADIUS * std::sqrt(randomFloat(0.0f, 1.0f));
+            float x = centerX[k % clusters] + std::cos(angle) * dist;
+            float y = centerY[k % clusters] + std::sin(angle) * dist;
+            return TransformComponent{ std::max(margin, std::min(maxX, x)), std::max(margin, std::min(maxY, y)) };
+        };
+
         // Player
-        playerID = registry.createEntity();
-        registry.transforms[playerID] = { WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 };
-        registry.velocities[playerID] = { 0, 0 };
-        registry.sprites[playerID] = { true, 0, 255, 0, 30, 30 };
-        registry.colliders[playerID] = { true, 15, TYPE_PLAYER };
+        player = registry.createEntity<TransformComponent, VelocityComponent, BoundsComponent, SpriteComponent, ColliderComponent>();
+        registry.set(player, TransformComponent{ worldWidth / 2, worldHeight / 2 });
+        registry.set(player, VelocityComponent{ 0, 0 });
+        registry.set(player, BoundsComponent{ worldWidth - 30.0f, worldHeight - 30.0f });
+        registry.set(player, SpriteComponent{ 0, 255, 0, 30, 30 });
+        registry.set(player, ColliderComponent{ 15, TYPE_PLAYER });
 
-        // Inamici (30)
-        for (int i = 0; i < 30; i++) {
-            int id = registry.createEntity();
-            registry.transforms[id] = { randomFloat(0, WINDOW_WIDTH), randomFloat(0, WINDOW_HEIGHT) };
-            registry.velocities[id] = { randomFloat(-250, 250), randomFloat(-250, 250) };
-            registry.sprites[id] = { true, 255, 50, 50, 25, 25 };
-            registry.colliders[id] = { true, 12, TYPE_ENEMY };
+        // Inamici (implicit 30 pe ecran) - ca jucatorul, plus tag-ul de stol (SteeringSystem)
+        for (int i = 0; i < enemies; i++) {
+            Entity e = registry.createEntity<TransformComponent, VelocityComponent, BoundsComponent, SpriteComponent, ColliderComponent, SteeringComponent>();
+            registry.set(e, spawn(i, 0.0f, worldWidth, worldHeight));
+            registry.set(e, VelocityComponent{ randomFloat(-250, 250), randomFloat(-250, 250) });
+            registry.set(e, BoundsComponent{ worldWidth - 25.0f, worldHeight - 25.0f });
+            registry.set(e, SpriteComponent{ 255, 50, 50, 25, 25 });
+            registry.set(e, ColliderComponent{ 12, TYPE_ENEMY });
         }
 
-        // Coins (1000 - Pentru Heatmap si Fizica)
-        for (int i = 0; i < 1000; i++) {
-            int id = registry.createEntity();
-            registry.transforms[id] = { randomFloat(50, WINDOW_WIDTH - 50), randomFloat(50, WINDOW_HEIGHT - 50) };
-            registry.sprites[id] = { true, 255, 215, 0, 15, 15 };
-            registry.colliders[id] = { true, 8, TYPE_COIN };
+        // Coins (implicit 1000 pe ecran - Pentru Heatmap si Fizica) - fara Velocity, doar tremura
+        for (int i = 0; i < coins; i++) {
+            Entity e = registry.createEntity<TransformComponent, JiggleComponent, SpriteComponent, ColliderComponent>();
+            registry.set(e, spawn(i, 50.0f, worldWidth - 50, worldHeight - 50));
+            registry.set(e, JiggleComponent{ 1.0f });
+            registry.set(e, SpriteComponent{ 255, 215, 0, 15, 15 });
+            registry.set(e, ColliderComponent{ 8, TYPE_COIN });
         }
     }
 
     void run() {
         SDL_Event ev;
-        Uint64 lastTime = SDL_GetPerformanceCounter();
-        unsigned int threads = std::thread::hardware_concurrency();
+        int threads = jobSystem.threadCount();
+        Profiler& profiler = Profiler::instance();
+        const double freq = (double)SDL_GetPerformanceFrequency();
+
+        // Primul snapshot inainte de pornire, ca render-ul sa aiba mereu ce desena
+        publishSnapshot();
+        simRunning.store(true);
+        simThread = std::thread(&GameEngine::simLoop, this);
 
         while (isRunning) {
+            snapshots.acquireLatest();
+            const RenderSnapshot& snap = snapshots.readBuffer();
+
             while (SDL_PollEvent(&ev)) {
                 if (ev.type == SDL_QUIT) isRunning = false;
                 if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE) isRunning = false;
-                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_r && gameplaySystem.gameOver) {
-                    gameplaySystem.gameOver = false;
-                    gameplaySystem.score = 0;
-                    registry.sprites[playerID].r = 0;
-                    registry.velocities[playerID] = { 0,0 };
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_b) renderSystem.batched = !renderSystem.batched;
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_o) overlay.visible = !overlay.visible;
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_p && !profiler.isCapturing()) {
+                    profiler.beginCapture(TRACE_FRAMES, "trace_phase2.json");
                 }
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_r && snap.gameOver) restartRequested.store(true);
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_F5) recordToggle.store(true);
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_g) broadphaseToggle.store(true);
+                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_z) sleepToggle.store(true);
             }
-            const Uint8* keys = SDL_GetKeyboardState(NULL);
+            inputBits.store(InputSystem::sample(SDL_GetKeyboardState(NULL)), std::memory_order_relaxed);
 
-            Uint64 currentTime = SDL_GetPerformanceCounter();
-            float dt = (float)((currentTime - lastTime) * 1000 / (double)SDL_GetPerformanceFrequency()) / 1000.0f;
-            lastTime = currentTime;
+            {
+                // Tot frame-ul, inclusiv asteptarea de vsync din SDL_RenderPresent
+                PROFILE_ZONE("Frame");
 
-            if (!gameplaySystem.gameOver) {
-                inputSystem.update(registry, keys, playerID);
-                physicsSystem.update(registry, dt); // Multi-threaded Movement
-                gameplaySystem.update(registry, playerID); // Main-thread Grid + Collision
-            }
+                // Cat din pasul urmator a trecut de la publicare: desenam intre starea
+                // de dinainte si cea de dupa ultimul pas (o latenta de cel mult un pas)
+                float alpha = (float)((double)(SDL_GetPerformanceCounter() - snap.publishTime) / freq / SIM_DT);
+                alpha = std::max(0.0f, std::min(1.0f, alpha));
 
-            renderSystem.render(registry, renderer, gameplaySystem); // Heatmap Render
+                camera.follow(snap.playerPrevX + (snap.playerX - snap.playerPrevX) * alpha,
+                    snap.playerPrevY + (snap.playerY - snap.playerPrevY) * alpha, worldWidth, worldHeight);
+                renderSystem.render(snap, alpha, renderer, camera, jobSystem); // Heatmap Render ('B': batched / per-rect)
+                overlay.render(renderer, profiler, threads, snap.entityCount); // 'O'
+
+                PROFILE_ZONE("Render/present");
+                SDL_RenderPresent(renderer);
+            }
+            profiler.endFrame();
 
             static Uint32 lastTitle = 0;
             if (SDL_GetTicks() - lastTitle > 100) {
                 lastTitle = SDL_GetTicks();
-                std::string title = "Engine MT (" + std::to_string(threads) + " cores) | FPS: " + std::to_string((int)(1.0f / dt)) +
-                    " | Score: " + std::to_string(gameplaySystem.score);
+                float frameMs = profiler.averageMs("Frame");
+                int fps = frameMs > 0.0f ? (int)(1000.0f / frameMs) : 0;
+                std::string title = "Engine MT (" + std::to_string(threads) + " cores, " + simdLevelName(simdLevel) + ") | FPS: " + std::to_string(fps) +
+                    " | Sim: " + std::to_string((int)(1.0f / SIM_DT)) + " Hz" +
+                    " | Entities: " + std::to_string(snap.entityCount) +
+                    " | Score: " + std::to_string(snap.score) +
+                    (renderSystem.batched ? " [BATCH]" : " [PER-RECT]") +
+                    (snap.broadphase == BROADPHASE_SWEEP ? " [SWEEP]" : " [GRID]") +
+                    (snap.sleeping >= 0 ? " | Asleep: " + std::to_string(snap.sleeping) : std::string()) +
+                    (snap.recording ? " [REC]" : "");
                 SDL_SetWindowTitle(window, title.c_str());
             }
         }
+
+        simRunning.store(false);
+        simThread.join();
+
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
     }
+
+    // Fara fereastra si fara pauze: `warmup` pasi nemasurati, apoi `frames` pasi cu SIM_DT
+    // cat de repede se poate. Dupa game over nivelul continua (ca 'R'), ca fiecare pas
+    // sa faca aceeasi munca. `queries` > 0: la final masoara si loturi de interogari.
+    // `perf`: contoare hardware pe fiecare etapa in pasii masurati (etapele ruleaza
+    // secvential, deci pasi/s scad putin fata de rularea normala).
+    void runHeadless(int frames, int warmup, int queries = 0, bool perf = false) {
+        Profiler& profiler = Profiler::instance();
+        const double freq = (double)SDL_GetPerformanceFrequency();
+
+        for (int i = 0; i < warmup; i++) {
+            step(0, true);
+            profiler.endFrame();
+        }
+
+        // Dupa warmup: workerii JobSystem exista deja, deci sunt numarati si ei
+        PerfCounters counters;
+        if (perf && counters.open()) scheduler.setPerfCounters(&counters);
+
+        std::vector<double> stepMs((size_t)frames);
+        double entityUpdates = 0.0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < frames; i++) {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            step(0, true);
+            stepMs[i] = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / freq;
+            entityUpdates += registry.entityCount();
+            profiler.endFrame();
+        }
+        double seconds = (double)(SDL_GetPerformanceCounter() - start) / freq;
+
+        std::sort(stepMs.begin(), stepMs.end());
+        std::cout << "Headless: " << frames << " pasi (" << warmup << " warmup) | " << jobSystem.threadCount() << " thread-uri, "
+            << simdLevelName(simdLevel) << " | " << registry.entityCount() << " entitati la final" << std::endl;
+        std::cout << "  Scheduler: " << scheduler.describe() << std::endl;
+        const ComponentArena& arena = registry.componentArena();
+        std::cout << "  Arena: " << (arena.active() ? std::to_string(arena.reservedBytes() >> 20) + " MB rezervati, " +
+            std::to_string(arena.spansInUse()) + " coloane, pagini mari " + hugePageModeName(arena.hugePages()) +
+            (arena.hugePages() == HUGEPAGES_TRANSPARENT ? " (" + std::to_string(arena.hugeSpansInUse()) + " coloane >= 2 MB)" : std::string()) :
+            std::string("inactiva (heap)"));
+        long hugeKB = anonHugePagesKB();
+        if (hugeKB >= 0) std::cout << " | AnonHugePages " << hugeKB << " kB";
+        std::cout << std::endl;
+        std::cout << "  Broadphase: " << (gameplaySystem.broadphase == BROADPHASE_SWEEP ? "sweep" : "grid");
+        if (gameplaySystem.broadphase == BROADPHASE_SWEEP) {
+            std::cout << " | ultimul pas: " << gameplaySystem.sweepPairCount << " perechi, " << gameplaySystem.sweepShifts
+                << " mutari in insertion sort" << (gameplaySystem.sweepFullSort ? " (std::sort)" : "");
+        }
+        std::cout << std::endl;
+        if (sleepEnabled()) {
+            int coins = 0;
+            for (Archetype* a : registry.view<TransformComponent, JiggleComponent>()) coins += a->count;
+            std::cout << "  Somn: " << gameplaySystem.sleepingCount() << " din " << coins << " monede adormite la final" << std::endl;
+        }
+        std::cout << "  Layout: Transform " << TransformStorage::name() << ", Velocity " << VelocityStorage::name()
+            << ", Bounds " << BoundsStorage::name() << std::endl;
+        std::cout << "  " << (seconds > 0.0 ? frames / seconds : 0.0) << " pasi/s | "
+            << (seconds > 0.0 ? entityUpdates / seconds / 1e6 : 0.0) << " M entitati actualizate/s | pas median "
+            << stepMs[stepMs.size() / 2] << " ms, p99 " << stepMs[std::min(stepMs.size() - 1, (size_t)(stepMs.size() * 0.99))] << " ms" << std::endl;
+
+        if (perf) {
+            scheduler.setPerfCounters(nullptr);
+            printPerf(counters, entityUpdates);
+        }
+
+        if (queries > 0) benchmarkQueries(queries);
+
+        // Zonele profiler-ului (media pe ultimii pasi din istoric)
+        uint64_t dropped = profiler.droppedEvents();
+        if (dropped > 0) std::cout << "  Profiler: " << dropped << " evenimente pierdute (ring plin)" << std::endl;
+        for (const Profiler::ZoneStats& z : profiler.stats()) {
+            std::cout << "  " << z.name << ": " << z.avgMs << " ms (p99 " << z.p99Ms << ")" << std::endl;
+        }
+    }
+
+    // O linie per etapa a schedulerului + totalul pasului, impartite la entitatile
+    // actualizate (suma pe pasi a numarului de entitati)
+    void printPerf(const PerfCounters& counters, double entityUpdates) {
+        if (!counters.any()) {
+            std::cout << "  Contoare hardware indisponibile (" << counters.lastError() << ")" << std::endl;
+            return;
+        }
+        std::cout << "  Contoare hardware (" << counters.threadCount() << " thread-uri, per entitate per pas"
+            << (counters.lastError().empty() ? "" : ", lipsa " + counters.lastError()) << "):" << std::endl;
+        PerfSample total;
+        for (size_t i = 0; i < scheduler.stageCount(); i++) {
+            const PerfSample& s = scheduler.stagePerfTotal(i);
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) total.value[e] += s.value[e];
+            std::cout << "    " << scheduler.stageName(i) << ": " << formatPerf(counters, s, entityUpdates) << std::endl;
+        }
+        std::cout << "    Total: " << formatPerf(counters, total, entityUpdates) << std::endl;
+    }
+
+    // Loturi de `count` interogari pe grid-ul ultimului pas, din puncte aleatoare ale lumii:
+    // pe rand cerc de 60 px (monede), dreptunghi de 128 x 128 si cei mai apropiati 8 (< 200 px)
+    void benchmarkQueries(int count) {
+        const int REPEATS = 50;
+        Profiler& profiler = Profiler::instance();
+        const double freq = (double)SDL_GetPerformanceFrequency();
+
+        SpatialQueryBatch batch;
+        for (int i = 0; i < count; i++) {
+            float x = randomFloat(0, worldWidth), y = randomFloat(0, worldHeight);
+            if (i % 3 == 0) batch.addRadius(x, y, 60.0f, typeBit(TYPE_COIN));
+            else if (i % 3 == 1) batch.addBox(x - 64.0f, y - 64.0f, x + 64.0f, y + 64.0f);
+            else batch.addNearest(x, y, 8, 200.0f);
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int r = 0; r < REPEATS; r++) {
+            gameplaySystem.runQueries(registry, batch, jobSystem);
+            profiler.endFrame();
+        }
+        double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / freq / REPEATS;
+        std::cout << "  Interogari: " << count << " per lot (cerc / dreptunghi / 8 vecini) | " << ms << " ms per lot, "
+            << ms * 1e6 / count << " ns per interogare, " << (double)batch.hits.size() / count << " rezultate per interogare" << std::endl;
+    }
+
+    // Fara fereastra: incarca snapshot-ul (mmap), refa fiecare pas inregistrat cu
+    // inputul lui si compara hash-ul starii. Intoarce false la prima diferenta.
+    bool replay(const char* path, SimdLevel simd) {
+        Profiler::instance().setThreadName("main");
+        if (!replaySource.open(path)) {
+            std::cerr << "Replay: nu pot deschide " << path << std::endl;
+            return false;
+        }
+
+        StateFile::SimState sim;
+        const StepRecord* steps = nullptr;
+        size_t stepTotal = 0;
+        if (!StateFile::load(replaySource, registry, sim, steps, stepTotal)) return false;
+
+        physicsSystem.seed = sim.seed;
+        physicsSystem.frame = sim.physicsFrame;
+        physicsSystem.init(simd);
+        steeringSystem.init(simd);
+        simdLevel = simd;
+        gameplaySystem.score = sim.score;
+        gameplaySystem.gameOver = sim.gameOver;
+        gameplaySystem.broadphase = sim.broadphase;
+        player = sim.player;
+        stepCount = sim.stepCount;
+        setWorldScreens(sim.worldScreens);
+
+        std::cout << "Replay: " << registry.entityCount() << " entitati, " << stepTotal << " pasi de la pasul "
+            << stepCount << " (" << jobSystem.threadCount() << " thread-uri, " << simdLevelName(simd) << ", broadphase "
+            << (sim.broadphase == BROADPHASE_SWEEP ? "sweep" : "grid") << ")" << std::endl;
+
+        const double freq = (double)SDL_GetPerformanceFrequency();
+        double totalMs = 0.0, worstMs = 0.0;
+        for (size_t i = 0; i < stepTotal; i++) {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            step(steps[i].input, steps[i].restart != 0);
+            double ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / freq;
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+
+            uint64_t hash = StateFile::hashState(registry, gameplaySystem.score, gameplaySystem.gameOver);
+            if (hash != steps[i].hash) {
+                std::cerr << "Replay: starea difera la pasul " << i << " (pasul simularii " << stepCount - 1 << ")" << std::endl;
+                return false;
+            }
+        }
+
+        std::cout << "Replay OK: " << stepTotal << " pasi identici | medie "
+            << (stepTotal > 0 ? totalMs / (double)stepTotal : 0.0) << " ms/pas | max " << worstMs << " ms" << std::endl;
+        return true;
+    }
+};
+
+const char* const GameEngine::REPLAY_PATH = "replay_phase2.bin";
+
+// --- BATCH DE LUMI (--batch N) ---
+// Multe simulari independente in acelasi proces (baleieri de parametri, antrenare de
+// boti). Fiecare lume e un GameEngine headless cu JobSystem de un singur thread (etapele
+// si parallelFor-urile ei ruleaza inline), iar lumile se impart pe core-uri printr-un
+// JobSystem comun, cate o lume intreaga pe bucata: o lume face toti pasii pe acelasi
+// core, cu datele in cache-ul lui, si lumile nu impart nimic, deci throughput-ul creste
+// liniar cu core-urile cat timp sunt mai multe lumi decat thread-uri.
+// Lumea w porneste din seed + w si e exact rularea `--headless --seed (seed + w)` cu
+// aceleasi optiuni; hash-ul combinat nu depinde de --threads.
+// Vectorizarea ramane in interiorul lumii (kernel-ele SIMD pe coloanele SoA), nu peste
+// lumi: entitatile unei lumi umplu deja benzile, iar lumile diverg (game over, monede
+// colectate, vecini diferiti), deci benzile intercalate ar fi mereu partial goale.
+struct BatchConfig {
+    int worlds = 0;
+    int steps = 600;   // Masurati, per lume
+    int warmup = 60;
+    uint32_t seed = 0;
+    SimdLevel simd = SIMD_SCALAR;
+    int screens = DEFAULT_WORLD_SCREENS;
+    int enemies = -1, coins = -1; // -1 = pe ecran x arie
+    HugePageMode hugePages = HUGEPAGES_OFF; // Lumi mici: o pagina de 2 MB per coloana ar fi risipa
+    BroadphaseMode broadphase = BROADPHASE_GRID;
+    int clusters = 0;
+    bool sleep = false;
+    unsigned int threads = 0;     // Thread-urile batch-ului, 0 = cate core-uri
 };
 
+int runBatch(const BatchConfig& cfg) {
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    int area = cfg.screens * cfg.screens;
+    int enemies = cfg.enemies >= 0 ? cfg.enemies : ENEMIES_PER_SCREEN * area;
+    int coins = cfg.coins >= 0 ? cfg.coins : COINS_PER_SCREEN * area;
+
+    // Initializarea foloseste rand(), deci se face pe rand, pe main
+    Uint64 initStart = SDL_GetPerformanceCounter();
+    std::vector<std::unique_ptr<GameEngine>> worlds;
+    for (int w = 0; w < cfg.worlds; w++) {
+        uint32_t seed = cfg.seed + (uint32_t)w;
+        srand(seed);
+        worlds.emplace_back(new GameEngine(1));
+        worlds[w]->initWorld(seed, cfg.simd, cfg.screens, enemies, coins, cfg.hugePages, cfg.clusters);
+        worlds[w]->setBroadphase(cfg.broadphase);
+        if (cfg.sleep) worlds[w]->setSleep(true);
+    }
+    double initMs = (double)(SDL_GetPerformanceCounter() - initStart) * 1000.0 / freq;
+
+    JobSystem jobs(cfg.threads);
+    jobs.parallelFor(0, cfg.worlds, 1, [&](int start, int end) {
+        for (int w = start; w < end; w++) worlds[w]->advance(cfg.warmup);
+    });
+
+    // Fiecare lume scrie doar in propriul slot
+    std::vector<double> worldMs((size_t)cfg.worlds), worldUpdates((size_t)cfg.worlds);
+    Uint64 start = SDL_GetPerformanceCounter();
+    jobs.parallelFor(0, cfg.worlds, 1, [&](int first, int last) {
+        for (int w = first; w < last; w++) {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            worldUpdates[w] = worlds[w]->advance(cfg.steps);
+            worldMs[w] = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / freq;
+        }
+    });
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / freq;
+
+    // In ordinea lumilor, ca rezultatul sa nu depinda de ce thread a rulat ce lume
+    uint64_t combined = 0xcbf29ce484222325ULL;
+    double entityUpdates = 0.0;
+    int entities = 0;
+    for (int w = 0; w < cfg.worlds; w++) {
+        combined = (combined ^ worlds[w]->stateHash()) * 0x100000001b3ULL;
+        entityUpdates += worldUpdates[w];
+        entities += worlds[w]->entityCount();
+    }
+    std::vector<double> sortedMs = worldMs;
+    std::sort(sortedMs.begin(), sortedMs.end());
+
+    std::cout << "Batch: " << cfg.worlds << " lumi x " << cfg.steps << " pasi (" << cfg.warmup << " warmup) | "
+        << jobs.threadCount() << " thread-uri, " << simdLevelName(cfg.simd) << " | " << enemies + coins + 1
+        << " entitati / lume la pornire, " << entities << " in total la final" << std::endl;
+    std::cout << "  Init: " << initMs << " ms | pagini mari " << hugePageModeName(cfg.hugePages) << std::endl;
+    std::cout << "  " << (seconds > 0.0 ? (double)cfg.worlds * cfg.steps / seconds : 0.0) << " pasi-lume/s | "
+        << (seconds > 0.0 ? entityUpdates / seconds / 1e6 : 0.0) << " M entitati actualizate/s | lume (" << cfg.steps
+        << " pasi): min " << sortedMs.front() << " ms, mediana " << sortedMs[sortedMs.size() / 2]
+        << " ms, max " << sortedMs.back() << " ms" << std::endl;
+    std::cout << "  Hash combinat: " << std::hex << combined << std::dec << std::endl;
+    return 0;
+}
+
+void printUsage(const char* exe) {
+    std::cerr << "Folosire: " << exe << " [--seed N] [--simd scalar|sse2|avx2|avx512] [--world N] [--threads N]\n"
+        << "    [--broadphase grid|sweep] [--clusters N] [--sleep] [--hugepages off|thp|explicit]\n"
+        << "    [--replay fisier] [--headless N] [--warmup N] [--enemies N] [--coins N] [--queries N]\n"
+        << "    [--perf] [--batch N]" << std::endl;
+}
+
+// Valoarea unui argument numeric; fals daca nu e un numar intreg (ex. "--headless --sleep")
+bool parseIntArg(const char* value, int& out) {
+    char* end = nullptr;
+    long v = strtol(value, &end, 10);
+    if (end == value || *end != 0 || v < INT32_MIN || v > INT32_MAX) return false;
+    out = (int)v;
+    return true;
+}
+
+bool isOneOf(const char* value, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        if (strcmp(value, name) == 0) return true;
+    }
+    return false;
+}
+
 int main(int argc, char* args[]) {
-    srand((unsigned int)time(0));
-    GameEngine game;
-    if (game.init()) {
+    // --seed N reproduce o rulare (nivelul initial si jiggle-ul monedelor)
+    // --simd scalar|sse2|avx2|avx512 limiteaza ISA-ul detectat (pt comparatie)
+    // --world N lume de N x N ecrane (implicit 1; entitatile cresc cu aria: 10 -> ~100k)
+    // --replay fisier reface un replay inregistrat cu F5 si verifica fiecare pas
+    // --headless N ruleaza N pasi fara SDL video si afiseaza throughput-ul; cu
+    //   --enemies N / --coins N (implicit pe ecran x arie), --warmup N, --threads N,
+    //   --queries N (masoara si loturi de N interogari spatiale pe grid)
+    // --hugepages off|thp|explicit paginile arenei de componente (implicit thp)
+    // --broadphase grid|sweep broadphase-ul coliziunilor la pornire (in joc: 'G')
+    // --clusters N inamicii si monedele pornesc in N grupuri in loc de uniform
+    // --sleep monedele linistite adorm (in joc: 'Z')
+    // --perf (cu --headless) contoare hardware per etapa: IPC, miss-uri per entitate
+    // --batch N ruleaza N lumi independente (seed, seed + 1, ...) in paralel, fiecare cu
+    //   --headless pasi (implicit 600) si --warmup; --world / --enemies / --coins /
+    //   --broadphase / --clusters / --sleep se aplica fiecarei lumi (implicit
+    //   --hugepages off), --threads = thread-urile batch-ului
+    uint32_t seed = (uint32_t)time(0);
+    SimdLevel simd = detectSimdLevel();
+    int worldScreens = DEFAULT_WORLD_SCREENS;
+    const char* replayPath = nullptr;
+    const char* hugePagesArg = nullptr;
+    int headlessFrames = 0, warmup = 60, enemies = -1, coins = -1, queries = 0, batchWorlds = 0;
+    int threadArg = 0;
+    BroadphaseMode broadphase = BROADPHASE_GRID;
+    int clusters = 0;
+    bool sleep = false, perf = false;
+
+    // Argumentele numerice si valoarea minima (cele mai mici sunt ridicate la ea)
+    struct IntFlag { const char* name; int* value; int minimum; };
+    const IntFlag intFlags[] = {
+        { "--world", &worldScreens, 1 }, { "--headless", &headlessFrames, 1 }, { "--warmup", &warmup, 0 },
+        { "--enemies", &enemies, 0 }, { "--coins", &coins, 0 }, { "--queries", &queries, 0 },
+        { "--batch", &batchWorlds, 1 }, { "--clusters", &clusters, 0 }, { "--threads", &threadArg, 0 }
+    };
+
+    // Un argument gresit opreste programul: altfel "--headless" fara numar ar porni jocul
+    // cu fereastra, iar "--broadphase swep" ar rula in tacere cu grid
+    for (int i = 1; i < argc; i++) {
+        const char* flag = args[i];
+        if (strcmp(flag, "--sleep") == 0) {
+            sleep = true;
+            continue;
+        }
+        if (strcmp(flag, "--perf") == 0) {
+            perf = true;
+            continue;
+        }
+
+        const IntFlag* intFlag = nullptr;
+        for (const IntFlag& f : intFlags) {
+            if (strcmp(flag, f.name) == 0) intFlag = &f;
+        }
+        bool known = intFlag || isOneOf(flag, { "--seed", "--simd", "--replay", "--hugepages", "--broadphase" });
+        if (!known) {
+            std::cerr << "Argument necunoscut: " << flag << std::endl;
+            printUsage(args[0]);
+            return 1;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Lipseste valoarea pentru " << flag << std::endl;
+            printUsage(args[0]);
+            return 1;
+        }
+
+        const char* value = args[++i];
+        bool valid = true;
+        if (intFlag) {
+            int n = 0;
+            valid = parseIntArg(value, n);
+            *intFlag->value = std::max(intFlag->minimum, n);
+        }
+        else if (strcmp(flag, "--seed") == 0) {
+            char* end = nullptr;
+            seed = (uint32_t)strtoul(value, &end, 10);
+            valid = end != value && *end == 0;
+        }
+        else if (strcmp(flag, "--simd") == 0) {
+            valid = isOneOf(value, { "scalar", "sse2", "avx2", "avx512" });
+            simd = std::min(simd, parseSimdLevel(value));
+        }
+        else if (strcmp(flag, "--broadphase") == 0) {
+            valid = isOneOf(value, { "grid", "sweep" });
+            broadphase = strcmp(value, "sweep") == 0 ? BROADPHASE_SWEEP : BROADPHASE_GRID;
+        }
+        else if (strcmp(flag, "--hugepages") == 0) {
+            valid = isOneOf(value, { "off", "thp", "explicit" });
+            hugePagesArg = value;
+        }
+        else replayPath = value;
+
+        if (!valid) {
+            std::cerr << "Valoare invalida pentru " << flag << ": " << value << std::endl;
+            printUsage(args[0]);
+            return 1;
+        }
+    }
+    worldScreens = std::min(MAX_WORLD_SCREENS, worldScreens);
+    unsigned int threads = (unsigned int)threadArg;
+
+    if (replayPath) {
+        GameEngine game(threads);
+        return game.replay(replayPath, simd) ? 0 : 1;
+    }
+
+    if (batchWorlds > 0) {
+        BatchConfig batch;
+        batch.worlds = batchWorlds;
+        if (headlessFrames > 0) batch.steps = headlessFrames;
+        batch.warmup = warmup;
+        batch.seed = seed;
+        batch.simd = simd;
+        batch.screens = worldScreens;
+        batch.enemies = enemies;
+        batch.coins = coins;
+        if (hugePagesArg) batch.hugePages = parseHugePageMode(hugePagesArg);
+        batch.broadphase = broadphase;
+        batch.clusters = clusters;
+        batch.sleep = sleep;
+        batch.threads = threads;
+        std::cout << "Seed: " << seed << " (lumea w: seed + w)" << std::endl;
+        return runBatch(batch);
+    }
+    HugePageMode hugePages = hugePagesArg ? parseHugePageMode(hugePagesArg) : HUGEPAGES_TRANSPARENT;
+    std::cout << "Seed: " << seed << " | SIMD: " << simdLevelName(simd) << " | World: "
+        << worldScreens << "x" << worldScreens << " ecrane" << std::endl;
+
+    srand(seed);
+    if (headlessFrames > 0) {
+        int area = worldScreens * worldScreens;
+        GameEngine game(threads);
+        game.initWorld(seed, simd, worldScreens, enemies >= 0 ? enemies : ENEMIES_PER_SCREEN * area,
+            coins >= 0 ? coins : COINS_PER_SCREEN * area, hugePages, clusters);
+        game.setBroadphase(broadphase);
+        if (sleep) game.setSleep(true);
+        game.runHeadless(headlessFrames, warmup, queries, perf);
+        return 0;
+    }
+
+    GameEngine game(threads);
+    if (game.init(seed, simd, worldScreens, hugePages, clusters)) {
+        game.setBroadphase(broadphase);
+        if (sleep) game.setSleep(true);
         game.run();
     }
     return 0;